@@ -0,0 +1,16 @@
+#pragma once
+
+// Counting heap allocations means replacing the global operator new for the
+// whole program, so it is a profiling build option: define
+// TYPING_MASTER_COUNT_ALLOCATIONS (CMake: -DTYPING_MASTER_COUNT_ALLOCATIONS=ON)
+// and link AllocationCounter.cpp. Other builds keep the standard allocator.
+#ifdef TYPING_MASTER_COUNT_ALLOCATIONS
+constexpr bool HEAP_ALLOCATIONS_COUNTED = true;
+
+// Heap allocations made through operator new so far, by every thread
+unsigned long long heapAllocationCount();
+#else
+constexpr bool HEAP_ALLOCATIONS_COUNTED = false;
+
+inline unsigned long long heapAllocationCount() { return 0; }
+#endif
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+
+// Fixed number of slots for game entities. Free slots are chained through
+// a list, so acquiring and releasing are O(1) and never touch the heap,
+// and a live entity keeps its slot until it is released. Iterating the
+// pool visits live entities in slot order.
+template <typename T, int N>
+class EntityPool {
+public:
+    static constexpr int CAPACITY = N;
+
+    EntityPool() { clear(); }
+
+    // Slot of a newly live entity, or -1 when every slot is taken. The
+    // entity keeps whatever the slot last held; callers set every field.
+    int acquire() {
+        if (freeHead < 0) return -1;
+        int slot = freeHead;
+        freeHead = nextFree[slot];
+        live[slot] = true;
+        liveCount++;
+        return slot;
+    }
+
+    void release(int slot) {
+        live[slot] = false;
+        nextFree[slot] = freeHead;
+        freeHead = slot;
+        liveCount--;
+    }
+
+    void clear() {
+        for (int i = 0; i < N; i++) {
+            live[i] = false;
+            nextFree[i] = i + 1 < N ? i + 1 : -1;
+        }
+        freeHead = 0;
+        liveCount = 0;
+    }
+
+    bool isLive(int slot) const { return live[slot]; }
+    int size() const { return liveCount; }
+
+    T& operator[](int slot) { return items[slot]; }
+    const T& operator[](int slot) const { return items[slot]; }
+
+    template <typename Pool, typename Item>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Item*;
+        using reference = Item&;
+
+        Iterator(Pool* pool, int slot) : pool(pool), current(slot) { skipDead(); }
+
+        Item& operator*() const { return (*pool)[current]; }
+        Item* operator->() const { return &(*pool)[current]; }
+        int slot() const { return current; }
+
+        Iterator& operator++() {
+            current++;
+            skipDead();
+            return *this;
+        }
+        bool operator!=(const Iterator& other) const { return current != other.current; }
+        bool operator==(const Iterator& other) const { return current == other.current; }
+
+    private:
+        void skipDead() {
+            while (current < N && !pool->isLive(current)) current++;
+        }
+
+        Pool* pool;
+        int current;
+    };
+
+    using iterator = Iterator<EntityPool, T>;
+    using const_iterator = Iterator<const EntityPool, const T>;
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, N); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, N); }
+
+private:
+    T items[N];
+    int nextFree[N];
+    bool live[N];
+    int freeHead;
+    int liveCount;
+};
@@ -0,0 +1,307 @@
+#include "FallingWordsSim.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace {
+    const float TWO_PI = 6.28318531f;
+}
+
+FallingWordsSim::FallingWordsSim(std::vector<std::string> words) :
+    wordList(std::move(words)) {
+    // Every word on screen plus one spawned per step of the longest
+    // frame, so popping never grows the list mid-game
+    popped.reserve(MAX_FALLING_WORDS + (int)(MAX_FRAME_TIME / STEP) + 1);
+    start(0, 0.0f, 0.0f);
+}
+
+void FallingWordsSim::start(unsigned int seed, float width, float height) {
+    fallingWords.clear();
+    std::fill(std::begin(firstLetterHead), std::end(firstLetterHead), -1);
+    activeSlot = -1;
+    wordGrid.clear();
+    playfieldWidth = width;
+    playfieldHeight = height;
+    points = 0;
+    livesLeft = STARTING_LIVES;
+    comboCount = 0;
+    comboTimeLeft = 0.0f;
+    spawnInterval = INITIAL_SPAWN_INTERVAL;
+    currentBaseSpeed = BASE_WORD_SPEED;
+    spawnTimer = 0.0f;
+    difficultyTimer = 0.0f;
+    gameSeed = seed;
+    rng.seed(seed);
+    stepCount = 0;
+    accumulator = 0.0f;
+    pendingKeyCount = 0;
+    hasPendingClick = false;
+    popped.clear();
+}
+
+void FallingWordsSim::queueKey(char key) {
+    if (pendingKeyCount < MAX_PENDING_KEYS) pendingKeys[pendingKeyCount++] = key;
+}
+
+void FallingWordsSim::queueClick(float x, float y) {
+    hasPendingClick = true;
+    pendingClickX = x;
+    pendingClickY = y;
+}
+
+void FallingWordsSim::advance(float frameTime) {
+    popped.clear();
+
+    // However the frames fall, the game sees the same steps
+    accumulator += std::min(frameTime, MAX_FRAME_TIME);
+    while (accumulator >= STEP && !isOver()) {
+        runStep();
+        accumulator -= STEP;
+    }
+}
+
+void FallingWordsSim::step() {
+    popped.clear();
+    if (!isOver()) runStep();
+}
+
+void FallingWordsSim::runStep() {
+    const float dt = STEP;
+    stepCount++;
+    spawnTimer += dt;
+    difficultyTimer += dt;
+
+    for (int i = 0; i < pendingKeyCount; i++) {
+        typeKey(pendingKeys[i]);
+    }
+    pendingKeyCount = 0;
+
+    if (hasPendingClick) {
+        click(pendingClickX, pendingClickY);
+        hasPendingClick = false;
+    }
+
+    // Update falling words
+    for (auto it = fallingWords.begin(); it != fallingWords.end(); ++it) {
+        FallingWord& word = *it;
+        word.prevY = word.y;
+        word.y += word.speed * dt;
+        word.wobbleTime += dt;
+
+        if (word.clickAnimScale > 1.0f) {
+            word.clickAnimScale = std::max(1.0f, word.clickAnimScale - dt * 2);
+        }
+
+        if (word.y > playfieldHeight + 50) {
+            livesLeft--;
+            popped.push_back({ word.x, word.y, word.hue, true });
+
+            // The iterator moves on by slot, so releasing this one is safe
+            removeWord(it.slot());
+            if (isOver()) return;
+        }
+    }
+
+    rebuildWordGrid();
+
+    if (spawnTimer >= spawnInterval) {
+        spawnTimer = 0.0f;
+        spawnWord();
+    }
+
+    // Handle difficulty increase
+    if (difficultyTimer >= DIFFICULTY_INCREASE_INTERVAL) {
+        difficultyTimer = 0;
+
+        // Increase spawn rate but don't go below minimum interval
+        spawnInterval = std::max(MIN_SPAWN_INTERVAL, spawnInterval * SPAWN_INTERVAL_DECREASE);
+
+        // Increase base speed but don't exceed maximum
+        currentBaseSpeed = std::min(MAX_WORD_SPEED, currentBaseSpeed + SPEED_INCREMENT);
+    }
+
+    if (comboCount > 0) {
+        comboTimeLeft -= dt;
+        if (comboTimeLeft <= 0) {
+            comboCount = 0;
+        }
+    }
+}
+
+int FallingWordsSim::randomInt(int bound) {
+    // Plain modulo rather than a std distribution, whose output is up to
+    // the standard library and would differ between builds
+    return static_cast<int>(rng() % static_cast<unsigned int>(bound));
+}
+
+void FallingWordsSim::createCloudShape(FallingWord& word) {
+    float baseRadius = 50.0f;
+
+    for (int i = 0; i < CLOUD_POINTS; i++) {
+        CloudPoint& point = word.cloudPoints[i];
+        float angle = (float)i / CLOUD_POINTS * TWO_PI;
+        float randRadius = baseRadius * (0.8f + randomInt(40) / 100.0f);
+        point.radius = baseRadius * 0.5f * (0.8f + randomInt(40) / 100.0f);
+        point.x = cosf(angle) * randRadius;
+        point.y = sinf(angle) * randRadius * 0.7f;
+    }
+}
+
+void FallingWordsSim::spawnWord() {
+    if (wordList.empty()) return;
+
+    // With every slot taken the screen is full; skip this spawn
+    int slot = fallingWords.acquire();
+    if (slot < 0) return;
+
+    FallingWord& newWord = fallingWords[slot];
+    newWord.wordIndex = randomInt((int)wordList.size());
+    newWord.typedLength = 0;
+    newWord.x = pickSpawnX();
+    newWord.y = -50;
+    newWord.prevY = newWord.y;
+    newWord.speed = currentBaseSpeed + randomInt(100);
+    newWord.isActive = false;
+    newWord.hue = (float)randomInt(360);
+    newWord.wobbleTime = 0;
+    newWord.clickAnimScale = 1.0f;
+
+    createCloudShape(newWord);
+    indexWord(slot);
+    wordGrid.insert(slot, newWord.x, newWord.y);
+}
+
+void FallingWordsSim::rebuildWordGrid() {
+    wordGrid.clear();
+    for (auto it = fallingWords.begin(); it != fallingWords.end(); ++it) {
+        wordGrid.insert(it.slot(), it->x, it->y);
+    }
+}
+
+bool FallingWordsSim::isLaneFree(int lane) const {
+    // Anything in the top row of cells would overlap a cloud spawned above it
+    bool free = true;
+    wordGrid.forEachInCell(lane, 0, [&](int slot) {
+        if (fallingWords.isLive(slot)) free = false;
+        });
+    return free;
+}
+
+float FallingWordsSim::pickSpawnX() {
+    // Lanes are the grid columns a whole cloud fits in
+    const int cellSize = (int)SpatialGrid::CELL_SIZE;
+    int lanes = std::clamp(((int)playfieldWidth - 150) / cellSize + 1, 1, SpatialGrid::COLS);
+
+    // From a random lane, take the first free one; with most lanes free
+    // that is the first or second look. If all are busy, keep the random one.
+    int start = randomInt(lanes);
+    int lane = start;
+    for (int i = 0; i < lanes; i++) {
+        int candidate = (start + i) % lanes;
+        if (isLaneFree(candidate)) {
+            lane = candidate;
+            break;
+        }
+    }
+
+    // A little jitter inside the lane so the words don't fall in columns
+    return lane * cellSize + cellSize / 2 + (randomInt(41) - 20);
+}
+
+void FallingWordsSim::indexWord(int slot) {
+    unsigned char first = wordList[fallingWords[slot].wordIndex][0];
+    firstLetterPrev[slot] = -1;
+    firstLetterNext[slot] = firstLetterHead[first];
+    if (firstLetterHead[first] >= 0) firstLetterPrev[firstLetterHead[first]] = slot;
+    firstLetterHead[first] = slot;
+}
+
+void FallingWordsSim::removeWord(int slot) {
+    unsigned char first = wordList[fallingWords[slot].wordIndex][0];
+    int prev = firstLetterPrev[slot];
+    int next = firstLetterNext[slot];
+    if (prev >= 0) firstLetterNext[prev] = next;
+    else firstLetterHead[first] = next;
+    if (next >= 0) firstLetterPrev[next] = prev;
+
+    if (activeSlot == slot) activeSlot = -1;
+    fallingWords.release(slot);
+}
+
+void FallingWordsSim::activateWord(int slot) {
+    // Only one word is active at a time, so only one needs resetting
+    if (activeSlot >= 0) {
+        fallingWords[activeSlot].isActive = false;
+        fallingWords[activeSlot].typedLength = 0;
+    }
+
+    FallingWord& word = fallingWords[slot];
+    word.isActive = true;
+    word.typedLength = 0;
+    word.clickAnimScale = 1.2f;
+    activeSlot = slot;
+}
+
+int FallingWordsSim::findTarget(char typed) const {
+    // The lowest word is the closest to costing a life
+    int target = -1;
+    for (int slot = firstLetterHead[(unsigned char)typed]; slot >= 0; slot = firstLetterNext[slot]) {
+        if (target < 0 || fallingWords[slot].y > fallingWords[target].y) target = slot;
+    }
+    return target;
+}
+
+void FallingWordsSim::click(float x, float y) {
+    // Only words in the cells around the click can be within reach
+    const float pickRadius = 50.0f;
+    int picked = -1;
+    float pickedDistanceSq = pickRadius * pickRadius;
+    wordGrid.forEachNear(x, y, pickRadius, [&](int slot) {
+        if (!fallingWords.isLive(slot)) return;  // Popped since the grid was built
+        const FallingWord& word = fallingWords[slot];
+        float dx = x - word.x;
+        float dy = y - word.y;
+        float distanceSq = dx * dx + dy * dy;
+        if (distanceSq < pickedDistanceSq && !word.isActive) {
+            picked = slot;
+            pickedDistanceSq = distanceSq;
+        }
+        });
+
+    if (picked >= 0) {
+        activateWord(picked);
+    }
+}
+
+void FallingWordsSim::typeKey(char typed) {
+    if (activeSlot >= 0) {
+        // If there's an active word, try to continue typing it
+        FallingWord& activeWord = fallingWords[activeSlot];
+        const std::string& text = wordList[activeWord.wordIndex];
+        if (activeWord.typedLength < (int)text.length() &&
+            typed == text[activeWord.typedLength]) {
+
+            activeWord.typedLength++;
+
+            // Word completed
+            if (activeWord.typedLength == (int)text.length()) {
+                int pointsEarned = 100 * (comboCount + 1);
+                points += pointsEarned;
+
+                comboCount = std::min(comboCount + 1, MAX_COMBO);
+                comboTimeLeft = COMBO_TIME_LIMIT;
+
+                popped.push_back({ activeWord.x, activeWord.y, activeWord.hue, false });
+                removeWord(activeSlot);
+            }
+        }
+    }
+    else {
+        // If no word is active, take the lowest word that starts with the typed character
+        int target = findTarget(typed);
+        if (target >= 0) {
+            activateWord(target);
+            fallingWords[target].typedLength = 1;
+        }
+    }
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "EntityPool.h"
+#include "SpatialGrid.h"
+
+// The falling words game without the drawing: words, typing, clicks,
+// lives and score. It advances in STEP steps, reads nothing from the
+// window, and takes every random number from a generator seeded by
+// start(). The same seed, playfield size and inputs on the same steps
+// always play out the same game, whatever the frame rate.
+class FallingWordsSim {
+public:
+    static constexpr float STEP = 1.0f / 60.0f;
+    static constexpr float MAX_FRAME_TIME = 0.25f;  // Longer hitches are dropped, not caught up
+    static constexpr int CLOUD_POINTS = 8;
+    static constexpr int MAX_FALLING_WORDS = 64;
+    static constexpr int MAX_PENDING_KEYS = 32;
+    static constexpr int STARTING_LIVES = 3;
+    static constexpr int MAX_COMBO = 5;
+    static constexpr float COMBO_TIME_LIMIT = 3.0f;
+
+    struct CloudPoint {
+        float x, y;
+        float radius;
+    };
+
+    // Plain data, so spawning and popping a word never allocates
+    struct FallingWord {
+        int wordIndex;            // Into the word list
+        int typedLength;          // How much of the word has been typed correctly
+        float x;
+        float y;
+        float prevY;              // y one step ago, for drawing between steps
+        float speed;
+        bool isActive;
+        float hue;                // Of the pop when the word is typed
+        CloudPoint cloudPoints[CLOUD_POINTS];
+        float wobbleTime;
+        float clickAnimScale;
+    };
+    static_assert(std::is_trivially_copyable<FallingWord>::value, "FallingWord must stay plain data");
+
+    using WordPool = EntityPool<FallingWord, MAX_FALLING_WORDS>;
+
+    // A word that left play, for the pop effect
+    struct Pop {
+        float x, y;
+        float hue;
+        bool missed;  // Fell off the bottom instead of being typed
+    };
+
+    explicit FallingWordsSim(std::vector<std::string> words);
+
+    // A new game on a playfield of this size, which stays fixed until the
+    // next start so a resized window can't change how the game plays out
+    void start(unsigned int seed, float width, float height);
+
+    // Input for the next step; keys past MAX_PENDING_KEYS are dropped
+    void queueKey(char key);
+    void queueClick(float x, float y);
+
+    // Runs the whole steps frameTime adds up to, keeping the remainder
+    void advance(float frameTime);
+    void step();
+
+    // Words that left play during the last advance() or step()
+    const std::vector<Pop>& pops() const { return popped; }
+
+    const WordPool& words() const { return fallingWords; }
+    const std::string& text(const FallingWord& word) const { return wordList[word.wordIndex]; }
+    unsigned int seed() const { return gameSeed; }
+    long long steps() const { return stepCount; }
+    float renderAlpha() const { return accumulator / STEP; }  // How far drawing is between the last two steps
+    int score() const { return points; }
+    int lives() const { return livesLeft; }
+    int combo() const { return comboCount; }
+    float comboTimer() const { return comboTimeLeft; }
+    bool isOver() const { return livesLeft <= 0; }
+
+private:
+    static constexpr float INITIAL_SPAWN_INTERVAL = 2.0f;
+    static constexpr float MIN_SPAWN_INTERVAL = 0.5f;         // Fastest spawn rate
+    static constexpr float SPAWN_INTERVAL_DECREASE = 0.95f;   // How much to decrease interval
+    static constexpr float BASE_WORD_SPEED = 100.0f;
+    static constexpr float MAX_WORD_SPEED = 300.0f;           // Maximum falling speed
+    static constexpr float SPEED_INCREMENT = 20.0f;           // How much to increase speed
+    static constexpr float DIFFICULTY_INCREASE_INTERVAL = 30.0f;
+
+    void runStep();
+    void spawnWord();
+    void createCloudShape(FallingWord& word);
+    void typeKey(char typed);
+    void click(float x, float y);
+    void indexWord(int slot);
+    void removeWord(int slot);
+    void activateWord(int slot);
+    int findTarget(char typed) const;
+    void rebuildWordGrid();
+    bool isLaneFree(int lane) const;
+    float pickSpawnX();
+    int randomInt(int bound);
+
+    std::vector<std::string> wordList;  // Not changed once the game is created
+    WordPool fallingWords;
+
+    // Live words by first letter, as lists linked through their slots, so
+    // a keystroke only looks at the words it could start
+    int firstLetterHead[256];
+    int firstLetterNext[MAX_FALLING_WORDS];
+    int firstLetterPrev[MAX_FALLING_WORDS];
+    int activeSlot;  // Word being typed, -1 if none
+
+    // Word positions as of the last step, for click picking and for
+    // keeping new words out of lanes that are still busy at the top
+    SpatialGrid wordGrid{ MAX_FALLING_WORDS };
+
+    float playfieldWidth;
+    float playfieldHeight;
+    int points;
+    int livesLeft;
+    int comboCount;
+    float comboTimeLeft;
+    float spawnInterval;
+    float currentBaseSpeed;
+    float spawnTimer;
+    float difficultyTimer;
+
+    std::mt19937 rng;
+    unsigned int gameSeed;
+    long long stepCount;
+    float accumulator;  // Frame time not yet simulated
+
+    char pendingKeys[MAX_PENDING_KEYS];
+    int pendingKeyCount;
+    bool hasPendingClick;
+    float pendingClickX, pendingClickY;
+
+    std::vector<Pop> popped;
+};
@@ -0,0 +1,73 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    const size_t INITIAL_BLOCK_SIZE = 64 * 1024;
+}
+
+FrameArena& FrameArena::instance() {
+    static FrameArena arena;
+    return arena;
+}
+
+FrameArena::FrameArena() {
+    blocks.push_back({ std::make_unique<char[]>(INITIAL_BLOCK_SIZE), INITIAL_BLOCK_SIZE });
+}
+
+void* FrameArena::allocate(size_t size, size_t alignment) {
+    Block* block = &blocks.back();
+    size_t start = (used + alignment - 1) & ~(alignment - 1);
+    if (start + size > block->size) {
+        size_t blockSize = std::max(block->size * 2, size + alignment);
+        blocks.push_back({ std::make_unique<char[]>(blockSize), blockSize });
+        block = &blocks.back();
+        start = 0;
+    }
+
+    used = start + size;
+    usedTotal += size;
+    return block->data.get() + start;
+}
+
+const char* FrameArena::format(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    va_list sizeArgs;
+    va_copy(sizeArgs, args);
+    int length = std::vsnprintf(nullptr, 0, fmt, sizeArgs);
+    va_end(sizeArgs);
+
+    char* text = static_cast<char*>(allocate(length > 0 ? length + 1 : 1, 1));
+    if (length > 0) std::vsnprintf(text, length + 1, fmt, args);
+    else text[0] = '\0';
+    va_end(args);
+    return text;
+}
+
+const char* FrameArena::copy(std::string_view text) {
+    char* copied = static_cast<char*>(allocate(text.length() + 1, 1));
+    std::memcpy(copied, text.data(), text.length());
+    copied[text.length()] = '\0';
+    return copied;
+}
+
+const char* FrameArena::repeat(char c, size_t count) {
+    char* text = static_cast<char*>(allocate(count + 1, 1));
+    std::memset(text, c, count);
+    text[count] = '\0';
+    return text;
+}
+
+void FrameArena::reset() {
+    if (blocks.size() > 1) {
+        // Alignment padding is why this rounds up past the bytes handed out
+        size_t blockSize = std::max(blocks.front().size, usedTotal + usedTotal / 4);
+        blocks.clear();
+        blocks.push_back({ std::make_unique<char[]>(blockSize), blockSize });
+    }
+    used = 0;
+    usedTotal = 0;
+}
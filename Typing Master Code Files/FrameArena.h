@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Scratch memory for the text and buffers a screen builds while drawing
+// one frame. Allocating is a pointer bump and everything is released at
+// once by reset(), which FrameStats::finishFrame() calls at the end of the
+// frame. Nothing from the arena may be kept past that, including across a
+// call that runs a frame loop of its own, like TypingTest::startTest.
+// Only the render thread uses it.
+class FrameArena {
+public:
+    static FrameArena& instance();
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    // printf-style text, like TextFormat without its small ring of buffers
+    const char* format(const char* fmt, ...);
+    // Terminated copies for DrawText
+    const char* copy(std::string_view text);
+    const char* repeat(char c, size_t count);
+
+    void reset();
+
+private:
+    FrameArena();
+
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    // Frames normally fit the first block. A frame that doesn't gets more
+    // blocks, and at the next reset they're replaced by one block that
+    // would have held it all.
+    std::vector<Block> blocks;
+    size_t used = 0;       // In the last block
+    size_t usedTotal = 0;  // Over every block this frame
+};
+
+// Standard allocator over the frame arena, for containers that only live
+// while a frame is drawn. Deallocation is a no-op.
+template <typename T>
+struct FrameAllocator {
+    using value_type = T;
+
+    FrameAllocator() = default;
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>&) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(FrameArena::instance().allocate(count * sizeof(T), alignof(T)));
+    }
+    void deallocate(T*, size_t) {}
+
+    template <typename U>
+    bool operator==(const FrameAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const FrameAllocator<U>&) const { return false; }
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
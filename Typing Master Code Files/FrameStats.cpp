@@ -0,0 +1,118 @@
+#include "FrameStats.h"
+#include "RedrawScheduler.h"
+#include "ProcessCpu.h"
+#include "AllocationCounter.h"
+#include "FrameArena.h"
+#include "raylib.h"
+#include <cstdio>
+
+FrameStats& FrameStats::instance() {
+    static FrameStats stats;
+    return stats;
+}
+
+void FrameStats::sampleCpuUsage() {
+    double wallTime = GetTime();
+    double cpuTime = processCpuSeconds();
+    if (sampleWallTime < 0.0) {
+        sampleWallTime = wallTime;
+        sampleCpuTime = cpuTime;
+    }
+    else if (wallTime - sampleWallTime >= 1.0) {
+        cpuPercent = (float)((cpuTime - sampleCpuTime) / (wallTime - sampleWallTime) * 100.0);
+        sampleWallTime = wallTime;
+        sampleCpuTime = cpuTime;
+
+        if (cpuLog) {
+            RedrawScheduler& scheduler = RedrawScheduler::instance();
+            std::printf("%.1f s  CPU %.1f%%  redraw %s\n", wallTime, cpuPercent,
+                scheduler.isOnDemand() ? "on demand" : "every frame");
+            std::fflush(stdout);
+        }
+    }
+}
+
+void FrameStats::sampleInputLatency() {
+    double now = GetTime();
+    double inputAfter = RedrawScheduler::instance().frameInputAfter();
+    if (inputAfter >= 0.0) {
+        double latency = now - inputAfter;
+        latencyTotal += latency;
+        latencyMax = latency > latencyMax ? latency : latencyMax;
+        latencySamples++;
+    }
+
+    if (latencyWindowStart < 0.0) latencyWindowStart = now;
+    if (now - latencyWindowStart >= 1.0) {
+        // Keep showing the last reading through a second without input
+        if (latencySamples > 0) {
+            latencyAvgMs = (float)(latencyTotal / latencySamples * 1000.0);
+            latencyMaxMs = (float)(latencyMax * 1000.0);
+        }
+        latencyTotal = 0.0;
+        latencyMax = 0.0;
+        latencySamples = 0;
+        latencyWindowStart = now;
+    }
+}
+
+void FrameStats::sampleHeapAllocations() {
+    unsigned long long allocations = heapAllocationCount();
+    allocationsInWindow += allocations - allocationsAtFrameEnd;
+    allocationsAtFrameEnd = allocations;
+    framesInWindow++;
+
+    double now = GetTime();
+    if (allocationWindowStart < 0.0) allocationWindowStart = now;
+    if (now - allocationWindowStart >= 1.0) {
+        allocationsPerFrame = (float)allocationsInWindow / framesInWindow;
+        allocationsInWindow = 0;
+        framesInWindow = 0;
+        allocationWindowStart = now;
+    }
+}
+
+void FrameStats::finishFrame() {
+    RedrawScheduler& scheduler = RedrawScheduler::instance();
+    if (IsKeyPressed(KEY_F3)) overlayVisible = !overlayVisible;
+    if (IsKeyPressed(KEY_F4)) scheduler.setOnDemand(!scheduler.isOnDemand());
+    if (IsKeyPressed(KEY_F5)) scheduler.setLowLatency(!scheduler.isLowLatency());
+
+    sampleCpuUsage();
+    sampleInputLatency();
+    if (HEAP_ALLOCATIONS_COUNTED) sampleHeapAllocations();
+    if (overlayVisible) {
+        DrawRectangle(10, GetScreenHeight() - 175, 340, 165, Fade(BLACK, 0.7f));
+        DrawText(TextFormat("FPS: %d", GetFPS()), 20, GetScreenHeight() - 170, 20, WHITE);
+        if (HEAP_ALLOCATIONS_COUNTED) {
+            DrawText(TextFormat("Heap allocations: %.1f/frame", allocationsPerFrame), 20, GetScreenHeight() - 147, 20, WHITE);
+        }
+        else {
+            DrawText("Heap allocations: not counted", 20, GetScreenHeight() - 147, 20, GRAY);
+        }
+        DrawText(TextFormat("Text draw calls: %d", drawCalls), 20, GetScreenHeight() - 124, 20, WHITE);
+        DrawText(TextFormat("CPU: %.1f%%", cpuPercent), 20, GetScreenHeight() - 101, 20, WHITE);
+        DrawText(TextFormat("Input to draw: %.1f ms avg, %.1f max", latencyAvgMs, latencyMaxMs),
+            20, GetScreenHeight() - 78, 20, WHITE);
+        DrawText(scheduler.isOnDemand() ? "Redraw: on demand" : "Redraw: every frame",
+            20, GetScreenHeight() - 55, 20, WHITE);
+        DrawText(scheduler.isLowLatency() ? "Pacing: low latency" : "Pacing: standard",
+            20, GetScreenHeight() - 32, 20, WHITE);
+
+        if (particleCount >= 0) {
+            DrawRectangle(10, GetScreenHeight() - 208, 340, 33, Fade(BLACK, 0.7f));
+            DrawText(TextFormat("Particles: %d, update %.2f ms", particleCount, particleUpdateMs),
+                20, GetScreenHeight() - 203, 20, WHITE);
+        }
+
+    }
+    if (overlayVisible || cpuLog) {
+        // Keep the readings current on a screen that is otherwise idle
+        scheduler.requestFrameIn(1.0);
+    }
+    drawCalls = 0;
+    particleCount = -1;
+
+    // Everything drawn this frame has been handed to raylib by now
+    FrameArena::instance().reset();
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+// Per-frame counters for a debug overlay, toggled with F3. Render code
+// reports what it issues; finishFrame() shows the totals and starts the
+// next frame's count. F4 switches between drawing every frame and drawing
+// on demand, and the overlay's CPU figure shows what that saves. F5 turns
+// low-latency pacing on and off; the overlay shows input-to-draw latency.
+// During a falling words game it also shows the live particle count.
+//
+// With logging on, each CPU reading is also printed to stdout, so idle CPU
+// can be recorded over a long run without watching the overlay.
+class FrameStats {
+public:
+    static FrameStats& instance();
+
+    void setCpuLog(bool enabled) { cpuLog = enabled; }
+
+    void countDrawCalls(int count = 1) { drawCalls += count; }
+    void countParticles(int live, double updateSeconds) {
+        particleCount = live;
+        particleUpdateMs = (float)(updateSeconds * 1000.0);
+    }
+
+    // Call just before EndDrawing
+    void finishFrame();
+
+private:
+    FrameStats() = default;
+
+    void sampleCpuUsage();
+    void sampleInputLatency();
+    void sampleHeapAllocations();
+
+    bool overlayVisible = false;
+    bool cpuLog = false;
+    int drawCalls = 0;
+
+    // Left at -1 on frames with no particle system running
+    int particleCount = -1;
+    float particleUpdateMs = 0.0f;
+
+    // Process CPU time over wall time, measured over about a second
+    float cpuPercent = 0.0f;
+    double sampleWallTime = -1.0;
+    double sampleCpuTime = 0.0;
+
+    // Input-to-draw latency of the frames that handled input, over the
+    // last second, as upper bounds
+    float latencyAvgMs = 0.0f;
+    float latencyMaxMs = 0.0f;
+    double latencyTotal = 0.0;
+    double latencyMax = 0.0;
+    int latencySamples = 0;
+    double latencyWindowStart = -1.0;
+
+    // Heap allocations between the last two frame ends, averaged over a second
+    unsigned long long allocationsAtFrameEnd = 0;
+    unsigned long long allocationsInWindow = 0;
+    int framesInWindow = 0;
+    double allocationWindowStart = -1.0;
+    float allocationsPerFrame = 0.0f;
+};
@@ -1,22 +1,29 @@
 #include "Games.h"
+#include "PersistenceQueue.h"
+#include "HighScoreLog.h"
+#include "RedrawScheduler.h"
+#include "FrameArena.h"
+#include "FrameStats.h"
 #include <fstream>
 #include <ctime>
+#include <chrono>
 #include <cmath>
 #include <algorithm>
 #include <map>
 #include <sstream>
 
 // Add user score tracking
-std::map<std::string, int> userHighScores;
 std::string currentUser;
 
-FallingWordsGame::FallingWordsGame(const std::string& username) {
+FallingWordsGame::FallingWordsGame(const std::string& username) :
+    sim(LoadWordsFromFile("words.txt")) {
     currentUser = username;
+    // Only looks use rand(), screen shake and pop particles; the game
+    // itself draws from its own seeded generator
     srand(static_cast<unsigned>(time(0)));
     InitializeTheme();
-    LoadWordsFromFile("words.txt");
     LoadHighScores();
-    ResetGame();
+    ResetGame(static_cast<unsigned>(time(0)));
 }
 
 void FallingWordsGame::InitializeTheme() {
@@ -28,46 +35,54 @@ void FallingWordsGame::InitializeTheme() {
     textColor = BLACK;                             // Changed text color to black
 }
 void FallingWordsGame::LoadHighScores() {
-    std::ifstream file("highscores.txt");
-    std::string line, username;
-    int score;
-
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        if (iss >> username >> score) {
-            userHighScores[username] = score;
-        }
-    }
+    // The shared board reads highscores.txt the first time only; it is
+    // refreshed from the log again when a game over shows it
+    highScore = Leaderboard::shared().scoreOf(currentUser);
+    leaderboardRank = 0;
+    leaderboardPlayers = 0;
+}
 
-    // Set current user's high score
-    auto it = userHighScores.find(currentUser);
-    if (it != userHighScores.end()) {
-        highScore = it->second;
-    }
-    else {
-        highScore = 0;
+void FallingWordsGame::SaveHighScore() {
+    if (sim.score() > highScore) {
+        highScore = sim.score();
+        Leaderboard::shared().submit(currentUser, highScore);
+
+        // Append the new best in the background
+        PersistenceQueue::instance().saveHighScore(currentUser, highScore);
     }
 }
 
-void FallingWordsGame::SaveHighScore() {
-    if (score > highScore) {
-        highScore = score;
-        userHighScores[currentUser] = highScore;
-
-        // Save all high scores
-        std::ofstream file("highscores.txt");
-        for (const auto& pair : userHighScores) {
-            file << pair.first << " " << pair.second << "\n";
-        }
+void FallingWordsGame::CacheLeaderboard() {
+    const Leaderboard& board = Leaderboard::shared();
+    leaderboardRank = board.rankOf(currentUser);
+    leaderboardPlayers = static_cast<int>(board.playerCount());
+    topScores = board.top(LEADERBOARD_SIZE);
+}
+
+void FallingWordsGame::RefreshLeaderboard() {
+    if (leaderboardRefresh.valid()) return;
+    leaderboardRefresh = std::async(std::launch::async, [] {
+        return HighScoreLog().load();
+    });
+}
+
+void FallingWordsGame::PollLeaderboardRefresh() {
+    if (!leaderboardRefresh.valid() ||
+        leaderboardRefresh.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
     }
+
+    Leaderboard::shared().merge(leaderboardRefresh.get());
+    CacheLeaderboard();
 }
 
-void FallingWordsGame::LoadWordsFromFile(const std::string& filename) {
+std::vector<std::string> FallingWordsGame::LoadWordsFromFile(const std::string& filename) {
+    std::vector<std::string> wordList;
     std::ifstream file(filename);
     if (!file.is_open()) {
         // Add some default words if file can't be opened
         wordList = { "hello", "world", "game", "play", "type", "fast", "score", "win" };
-        return;
+        return wordList;
     }
 
     std::string word;
@@ -80,231 +95,70 @@ void FallingWordsGame::LoadWordsFromFile(const std::string& filename) {
         // Add default words if file was empty
         wordList = { "hello", "world", "game", "play", "type", "fast", "score", "win" };
     }
-}
-
-void FallingWordsGame::CreateCloudShape(FallingWord& word) {
-    word.cloudPoints.clear();
-    float baseRadius = 50.0f;
-
-    for (int i = 0; i < CLOUD_POINTS; i++) {
-        CloudPoint point;
-        float angle = (float)i / CLOUD_POINTS * 2 * PI;
-        float randRadius = baseRadius * (0.8f + (rand() % 40) / 100.0f);
-        point.radius = baseRadius * 0.5f * (0.8f + (rand() % 40) / 100.0f);
-        point.x = cosf(angle) * randRadius;
-        point.y = sinf(angle) * randRadius * 0.7f;
-        word.cloudPoints.push_back(point);
-    }
-}
-
-void FallingWordsGame::SpawnWord() {
-    if (wordList.empty()) return;
-
-    FallingWord newWord;
-    newWord.word = wordList[rand() % wordList.size()];
-    newWord.typedPart = "";
-    newWord.x = rand() % (GetScreenWidth() - 150) + 75;
-    newWord.y = -50;
-    newWord.speed = currentBaseSpeed + rand() % 100;
-    newWord.isActive = false;
-    newWord.scale = 1.0f;
-    newWord.alpha = 1.0f;
-    newWord.wobbleTime = 0;
-    newWord.clickAnimScale = 1.0f;
-
-    float hue = rand() % 360;
-    Color baseColor = ColorFromHSV(hue, 0.5f, 0.95f);
-    newWord.bubbleColor = ColorAlpha(baseColor, 0.9f);
-
-    CreateCloudShape(newWord);
-    fallingWords.push_back(newWord);
+    return wordList;
 }
 
 void FallingWordsGame::CreatePopEffect(float x, float y, Color color) {
     for (int i = 0; i < 20; i++) {
-        Particle p;
-        p.position = { x, y };
         float angle = (rand() % 360) * DEG2RAD;
         float speed = rand() % 200 + 100;
-        p.velocity = {
-            cosf(angle) * speed,
-            sinf(angle) * speed
-        };
-        p.radius = rand() % 5 + 2;
-        p.lifetime = 1.0f;
-        p.color = color;
-        particles.push_back(p);
+        particles.spawn(x, y, cosf(angle) * speed, sinf(angle) * speed, rand() % 5 + 2, 1.0f,
+            (unsigned int)ColorToInt(color));
     }
     screenShake = 0.3f;
 }
 
-void FallingWordsGame::UpdateParticles() {
-    float dt = GetFrameTime();
-    for (auto it = particles.begin(); it != particles.end();) {
-        it->position.x += it->velocity.x * dt;
-        it->position.y += it->velocity.y * dt;
-        it->velocity.y += 500.0f * dt; // Gravity
-        it->lifetime -= dt;
-
-        if (it->lifetime <= 0) {
-            it = particles.erase(it);
-        }
-        else {
-            ++it;
-        }
-    }
-}
-
-void FallingWordsGame::UpdateCombo() {
-    float dt = GetFrameTime();
-    if (combo > 0) {
-        comboTimer -= dt;
-        if (comboTimer <= 0) {
-            combo = 0;
-        }
-    }
+void FallingWordsGame::UpdateParticles(float dt) {
+    double start = GetTime();
+    particles.update(dt);
+    FrameStats::instance().countParticles((int)particles.size(), GetTime() - start);
 }
 
 void FallingWordsGame::HandleClick(int x, int y) {
     if (!isRunning || isPaused) return;
-
-    for (auto& word : fallingWords) {
-        float dx = x - word.x;
-        float dy = y - word.y;
-        float distance = sqrtf(dx * dx + dy * dy);
-
-        if (distance < 50 && !word.isActive) {
-            // Deactivate other words
-            for (auto& otherword : fallingWords) {
-                otherword.isActive = false;
-                otherword.typedPart = "";
-            }
-
-            word.isActive = true;
-            word.clickAnimScale = 1.2f;
-            break;
-        }
-    }
-}
-
-void FallingWordsGame::UpdateWordTyping(char typed) {
-    // First, check if any word is currently active
-    auto activeWord = std::find_if(fallingWords.begin(), fallingWords.end(),
-        [](const FallingWord& word) { return word.isActive; });
-
-    if (activeWord != fallingWords.end()) {
-        // If there's an active word, try to continue typing it
-        if (activeWord->typedPart.length() < activeWord->word.length() &&
-            typed == activeWord->word[activeWord->typedPart.length()]) {
-
-            activeWord->typedPart += typed;
-
-            // Word completed
-            if (activeWord->typedPart == activeWord->word) {
-                int pointsEarned = 100 * (combo + 1);
-                score += pointsEarned;
-
-                combo = std::min(combo + 1, MAX_COMBO);
-                comboTimer = COMBO_TIME_LIMIT;
-
-                CreatePopEffect(activeWord->x, activeWord->y, activeWord->bubbleColor);
-                fallingWords.erase(activeWord);
-            }
-        }
-    }
-    else {
-        // If no word is active, look for a word that starts with the typed character
-        auto newActiveWord = std::find_if(fallingWords.begin(), fallingWords.end(),
-            [typed](const FallingWord& word) {
-                return !word.isActive && word.word[0] == typed;
-            });
-
-        if (newActiveWord != fallingWords.end()) {
-            // Deactivate all other words
-            for (auto& word : fallingWords) {
-                word.isActive = false;
-                word.typedPart = "";
-            }
-
-            // Activate the new word and add the first character
-            newActiveWord->isActive = true;
-            newActiveWord->typedPart = typed;
-            newActiveWord->clickAnimScale = 1.2f;
-        }
-    }
+    sim.queueClick(x, y);
 }
 
 void FallingWordsGame::UpdateGame() {
     if (!isRunning || isPaused) return;
 
-    float dt = GetFrameTime();
-    timer += dt;
-    difficultyTimer += dt;
+    float frameTime = std::min(GetFrameTime(), FallingWordsSim::MAX_FRAME_TIME);
 
+    // Screen shake and particles are only looks, so they follow the frame
     if (screenShake > 0) {
-        screenShake -= dt * 2;
+        screenShake -= frameTime * 2;
         if (screenShake < 0) screenShake = 0;
     }
 
-    // Handle keyboard input
+    // Handle keyboard input; the keys reach the game on its next step
     int key = GetCharPressed();
     while (key > 0) {
-        UpdateWordTyping((char)key);
+        sim.queueKey((char)key);
         key = GetCharPressed();
     }
 
     // Handle mouse input (optional)
     if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-        Vector2 mousePos = GetMousePosition();
-        HandleClick(mousePos.x, mousePos.y);
-    }
-
-    // Update falling words
-    for (auto& word : fallingWords) {
-        word.y += word.speed * dt;
-        word.wobbleTime += dt;
-
-        if (word.clickAnimScale > 1.0f) {
-            word.clickAnimScale = std::max(1.0f, word.clickAnimScale - dt * 2);
-        }
-
-        if (word.y > GetScreenHeight() + 50) {
-            lives--;
-            CreatePopEffect(word.x, word.y, RED);
-
-            if (lives <= 0) {
-                isRunning = false;
-                isGameOver = true;
-                SaveHighScore();
-            }
-        }
-    }
-
-    fallingWords.erase(
-        std::remove_if(fallingWords.begin(), fallingWords.end(),
-            [](const FallingWord& word) { return word.y > GetScreenHeight() + 50; }),
-        fallingWords.end()
-    );
-
-    if (timer >= spawnInterval) {
-        timer = 0.0f;
-        SpawnWord();
+        Vector2 mouse = GetMousePosition();
+        HandleClick(mouse.x, mouse.y);
     }
 
-    // Handle difficulty increase
-    if (difficultyTimer >= DIFFICULTY_INCREASE_INTERVAL) {
-        difficultyTimer = 0;
-
-        // Increase spawn rate but don't go below minimum interval
-        spawnInterval = std::max(MIN_SPAWN_INTERVAL, spawnInterval * SPAWN_INTERVAL_DECREASE);
-
-        // Increase base speed but don't exceed maximum
-        currentBaseSpeed = std::min(MAX_WORD_SPEED, currentBaseSpeed + SPEED_INCREMENT);
+    sim.advance(frameTime);
+    for (const FallingWordsSim::Pop& pop : sim.pops()) {
+        Color color = pop.missed ? RED : ColorAlpha(ColorFromHSV(pop.hue, 0.5f, 0.95f), 0.9f);
+        CreatePopEffect(pop.x, pop.y, color);
     }
+    if (sim.isOver()) EndGame();
 
+    UpdateParticles(frameTime);
+}
 
-    UpdateParticles();
-    UpdateCombo();
+void FallingWordsGame::EndGame() {
+    isRunning = false;
+    isGameOver = true;
+    SaveHighScore();
+    CacheLeaderboard();
+    RefreshLeaderboard();
 }
 
 // First modify the DrawGame() method in Games.cpp
@@ -313,9 +167,12 @@ void FallingWordsGame::DrawGame(bool beginEnd) {
 
     if (beginEnd) BeginDrawing();
     ClearBackground(backgroundColor);  // Always clear the entire screen first
+    RedrawScheduler::instance().requestFrame();
 
     // Draw the game elements only if we're running or showing game over screen
     if (isGameOver) {
+        PollLeaderboardRefresh();
+
         // Game over screen with full screen background
         DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), backgroundColor);
         DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), ColorAlpha(BLACK, 0.7f));
@@ -323,7 +180,7 @@ void FallingWordsGame::DrawGame(bool beginEnd) {
         int centerX = GetScreenWidth() / 2;
         int centerY = GetScreenHeight() / 2;
 
-        float frameWidth = 600;
+        float frameWidth = 900;  // Wide enough for the leaderboard beside the results
         float frameHeight = 550;  // Increased from 500 to 580 to accommodate the exit button
         float pulseScale = 1.0f + sinf(GetTime() * 2) * 0.02f;
 
@@ -351,47 +208,67 @@ void FallingWordsGame::DrawGame(bool beginEnd) {
             centerY - frameHeight / 2 + 50,
             60, primaryColor);
 
-        std::string userText = "Player: " + currentUser;
-        DrawText(userText.c_str(),
-            centerX - MeasureText(userText.c_str(), 30) / 2,
+        // Results on the left, leaderboard on the right
+        int infoX = centerX - 200;
+
+        const char* userText = FrameArena::instance().format("Player: %s", currentUser.c_str());
+        DrawText(userText,
+            infoX - MeasureText(userText, 30) / 2,
             centerY - 80,
             30, secondaryColor);
 
-        DrawText(TextFormat("Final Score: %d", score),
-            centerX - MeasureText(TextFormat("Final Score: %d", score), 40) / 2,
+        DrawText(TextFormat("Final Score: %d", sim.score()),
+            infoX - MeasureText(TextFormat("Final Score: %d", sim.score()), 40) / 2,
             centerY-30,
             40, primaryColor);
 
         DrawText(TextFormat("Personal Best: %d", highScore),
-            centerX - MeasureText(TextFormat("Personal Best: %d", highScore), 40) / 2,
+            infoX - MeasureText(TextFormat("Personal Best: %d", highScore), 40) / 2,
             centerY + 20,
             40, accentColor);
 
-        // Global high score display
-        int globalHighScore = 0;
-        std::string topPlayer;
-        for (const auto& pair : userHighScores) {
-            if (pair.second > globalHighScore) {
-                globalHighScore = pair.second;
-                topPlayer = pair.first;
-            }
+        if (leaderboardRank > 0) {
+            const char* rankText = TextFormat("You are #%d of %d players", leaderboardRank, leaderboardPlayers);
+            DrawText(rankText,
+                infoX - MeasureText(rankText, 20) / 2,
+                centerY + 80,
+                20, secondaryColor);
         }
 
-        std::string globalBestText = "Global Best: " + std::to_string(globalHighScore) + " by " + topPlayer;
-        DrawText(globalBestText.c_str(),
-            centerX - MeasureText(globalBestText.c_str(), 20) / 2,
-            centerY + 100,
-            20, secondaryColor);
+        // Enough to replay this game with --game-seed
+        const char* seedText = TextFormat("Seed %u", sim.seed());
+        DrawText(seedText,
+            infoX - MeasureText(seedText, 20) / 2,
+            centerY + 110,
+            20, accentColor);
+
+        // Top scores table
+        int tableLeft = centerX + 60;
+        int tableRight = centerX + 400;
+        int rowY = centerY - 130;
+        DrawText("TOP 10", tableLeft, rowY, 25, primaryColor);
+        rowY += 40;
+
+        for (size_t i = 0; i < topScores.size(); i++) {
+            const Leaderboard::Entry& entry = topScores[i];
+            Color rowColor = entry.username == currentUser ? primaryColor : secondaryColor;
+            const char* scoreText = TextFormat("%d", entry.score);
+
+            DrawText(TextFormat("%d.", (int)i + 1), tableLeft, rowY, 20, rowColor);
+            DrawText(entry.username.c_str(), tableLeft + 40, rowY, 20, rowColor);
+            DrawText(scoreText, tableRight - MeasureText(scoreText, 20), rowY, 20, rowColor);
+            rowY += 26;
+        }
 
         Rectangle btnBounds = {
-            centerX - 100,
+            infoX - 100,
             centerY + frameHeight / 2 - 120,
             200,
             40
         };
 
         Rectangle exitBounds = {
-           centerX - 100,
+           infoX - 100,
            centerY + frameHeight / 2 - 70, // Position it below Play Again
            200,
            40
@@ -418,13 +295,13 @@ void FallingWordsGame::DrawGame(bool beginEnd) {
 
         DrawRectangleLinesEx(btnBounds, 2, btnColor);
         DrawText("PLAY AGAIN",
-            centerX - MeasureText("PLAY AGAIN", 20) / 2,
+            infoX - MeasureText("PLAY AGAIN", 20) / 2,
             centerY + frameHeight / 2 - 110,
             20, btnColor);
 
         DrawRectangleLinesEx(exitBounds, 2, exitBtnColor);
         DrawText("EXIT TO MENU",
-            centerX - MeasureText("EXIT TO MENU", 20) / 2,
+            infoX - MeasureText("EXIT TO MENU", 20) / 2,
             centerY + frameHeight / 2 - 60,
             20, exitBtnColor);
     }
@@ -438,13 +315,16 @@ void FallingWordsGame::DrawGame(bool beginEnd) {
             shakeOffset.y = (rand() % 100 - 50) * screenShake * 0.1f;
         }
 
-        // Draw falling words
-        for (const auto& word : fallingWords) {
-            Vector2 pos = { word.x + shakeOffset.x, word.y + shakeOffset.y };
+        // Draw falling words where they were between the last two steps
+        float renderAlpha = sim.renderAlpha();
+        for (const auto& word : sim.words()) {
+            float y = word.prevY + (word.y - word.prevY) * renderAlpha;
+            float wobbleTime = word.wobbleTime - (1.0f - renderAlpha) * FallingWordsSim::STEP;
+            Vector2 pos = { word.x + shakeOffset.x, y + shakeOffset.y };
 
             // Draw cloud shape
             for (const auto& point : word.cloudPoints) {
-                float wobble = sinf(word.wobbleTime * 2 + point.x * 0.1f) * 3;
+                float wobble = sinf(wobbleTime * 2 + point.x * 0.1f) * 3;
                 Vector2 cloudPos = {
                     pos.x + point.x * word.clickAnimScale,
                     pos.y + point.y * word.clickAnimScale + wobble
@@ -460,19 +340,22 @@ void FallingWordsGame::DrawGame(bool beginEnd) {
                 ColorAlpha(primaryColor, word.isActive ? 1.0f : 0.8f));
 
             // Draw word text
-            const char* fullWord = word.word.c_str();
+            const std::string& text = sim.text(word);
+            const char* fullWord = text.c_str();
             float textWidth = MeasureText(fullWord, 20);
 
             if (word.isActive) {
                 Color typedColor = GREEN;
-                DrawText(word.typedPart.c_str(),
+                const char* typedPart = FrameArena::instance().copy(
+                    std::string_view(text).substr(0, word.typedLength));
+                DrawText(typedPart,
                     pos.x - textWidth / 2,
                     pos.y - 10,
                     20,
                     typedColor);
 
-                DrawText(fullWord + word.typedPart.length(),
-                    pos.x - textWidth / 2 + MeasureText(word.typedPart.c_str(), 20),
+                DrawText(fullWord + word.typedLength,
+                    pos.x - textWidth / 2 + MeasureText(typedPart, 20),
                     pos.y - 10,
                     20,
                     textColor);
@@ -487,30 +370,31 @@ void FallingWordsGame::DrawGame(bool beginEnd) {
         }
 
         // Draw particles
-        for (const auto& p : particles) {
-            Vector2 particlePos = { p.position.x + shakeOffset.x, p.position.y + shakeOffset.y };
-            DrawCircleV(particlePos, p.radius, ColorAlpha(p.color, p.lifetime));
+        for (size_t i = 0; i < particles.size(); i++) {
+            Vector2 particlePos = { particles.x(i) + shakeOffset.x, particles.y(i) + shakeOffset.y };
+            DrawCircleV(particlePos, particles.radius(i),
+                ColorAlpha(GetColor(particles.color(i)), particles.lifetime(i)));
         }
 
         // Draw HUD
         DrawRectangle(0, 0, GetScreenWidth(), 60, ColorAlpha(BLACK, 0.8f));
 
         float scoreScale = 1.0f + sinf(GetTime() * 4) * 0.1f;
-        DrawText(TextFormat("Score: %d", score),
+        DrawText(TextFormat("Score: %d", sim.score()),
             20, 15, 30 * scoreScale, primaryColor);
 
         DrawText("Lives:", GetScreenWidth() - 220, 15, 30, primaryColor);
         int heartSpacing = 35;
-        for (int i = 0; i < lives; i++) {
+        for (int i = 0; i < sim.lives(); i++) {
             DrawText("?", GetScreenWidth() - 120 + (i * heartSpacing), 15, 30, RED);
         }
 
         // Draw combo
-        if (combo > 0) {
-            float comboWidth = 140 * (comboTimer / COMBO_TIME_LIMIT);
-            std::string comboText = TextFormat("Combo x%d", combo + 1);
-            DrawText(comboText.c_str(),
-                GetScreenWidth() / 2 - MeasureText(comboText.c_str(), 30) / 2,
+        if (sim.combo() > 0) {
+            float comboWidth = 140 * (sim.comboTimer() / FallingWordsSim::COMBO_TIME_LIMIT);
+            const char* comboText = FrameArena::instance().format("Combo x%d", sim.combo() + 1);
+            DrawText(comboText,
+                GetScreenWidth() / 2 - MeasureText(comboText, 30) / 2,
                 15, 30, accentColor);
 
             DrawRectangle(GetScreenWidth() / 2 - 70, 50, 140, 5,
@@ -584,9 +468,7 @@ void FallingWordsGame::DrawGame(bool beginEnd) {
             if (CheckCollisionPointRec(GetMousePosition(), quitBtn)) {
                 DrawRectangleLinesEx(quitBtn, 2, secondaryColor);
                 if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
-                    isRunning = false;
-                    isGameOver = true;
-                    SaveHighScore();
+                    EndGame();
                     isPaused = false;
                 }
             }
@@ -605,17 +487,10 @@ void FallingWordsGame::DrawGame(bool beginEnd) {
 }
 
 
-void FallingWordsGame::ResetGame() {
-    fallingWords.clear();
+void FallingWordsGame::ResetGame(unsigned int seed) {
+    // The playfield is the window as the game starts, and stays that size
+    sim.start(seed, (float)GetScreenWidth(), (float)GetScreenHeight());
     particles.clear();
-    score = 0;
-    lives = 3;
-    combo = 0;
-    comboTimer = 0;
-    timer = 0.0f;
-    difficultyTimer = 0.0f;
-    spawnInterval = INITIAL_SPAWN_INTERVAL;
-    currentBaseSpeed = BASE_WORD_SPEED;  // Initialize base spee
     screenShake = 0.0f;
     isRunning = true;
     isGameOver = false;
@@ -623,7 +498,11 @@ void FallingWordsGame::ResetGame() {
 }
 
 void FallingWordsGame::StartGame() {
-    ResetGame();
+    StartGame(std::random_device{}());
+}
+
+void FallingWordsGame::StartGame(unsigned int gameSeed) {
+    ResetGame(gameSeed);
 }
 
 void FallingWordsGame::TogglePause() {
@@ -3,62 +3,31 @@
 
 #include <vector>
 #include <string>
+#include <future>
+#include <map>
 #include "raylib.h"
+#include "Leaderboard.h"
+#include "ParticlePool.h"
+#include "FallingWordsSim.h"
 
 class FallingWordsGame {
 private:
-    const float INITIAL_SPAWN_INTERVAL = 2.0f;
-    const float MIN_SPAWN_INTERVAL = 0.5f;  // Fastest spawn rate
-    const float SPAWN_INTERVAL_DECREASE = 0.95f;  // How much to decrease interval
-    const float BASE_WORD_SPEED = 100.0f;
-    const float MAX_WORD_SPEED = 300.0f;  // Maximum falling speed
-    const float SPEED_INCREMENT = 20.0f;   // How much to increase spee
-    float currentBaseSpeed;  // Add this as a class member
-    // Structures
-    struct CloudPoint {
-        float x, y;
-        float radius;
-    };
-
-    struct Particle {
-        Vector2 position;
-        Vector2 velocity;
-        float radius;
-        float lifetime;
-        Color color;
-    };
-
-    struct FallingWord {
-        std::string word;
-        std::string typedPart;    // Track what's been typed correctly
-        float x;
-        float y;
-        float speed;
-        bool isActive;
-        float scale;
-        float alpha;
-        Color bubbleColor;
-        std::vector<CloudPoint> cloudPoints;
-        float wobbleTime;
-        float clickAnimScale;
-    };
-
-    // Game state variables
-    std::vector<std::string> wordList;
-    std::vector<FallingWord> fallingWords;
-    std::vector<Particle> particles;
-    int score;
+    // The game itself; this class reads input, draws it and adds effects
+    FallingWordsSim sim;
+    ParticlePool particles;
     int highScore;
-    int lives;
-    int combo;
-    float comboTimer;
-    float spawnInterval;
-    float timer;
-    float difficultyTimer;
     bool isRunning;
     bool isGameOver;
     bool isPaused;
 
+    // Leaderboard snapshot taken at game over, so drawing it costs nothing per frame
+    int leaderboardRank;
+    int leaderboardPlayers;
+    std::vector<Leaderboard::Entry> topScores;
+    // highscores.txt re-read in the background while the board is shown,
+    // to pick up scores other running copies of the game have saved
+    std::future<std::map<std::string, int>> leaderboardRefresh;
+
     // Theme colors
     Color backgroundColor;
     Color primaryColor;
@@ -69,29 +38,26 @@ private:
     // Visual effects
     float screenShake;
 
-    // Constants
-    static constexpr float COMBO_TIME_LIMIT = 3.0f;
-    static constexpr float DIFFICULTY_INCREASE_INTERVAL = 30.0f;
-    static constexpr int MAX_COMBO = 5;
-    static constexpr int CLOUD_POINTS = 8;
+    static constexpr size_t LEADERBOARD_SIZE = 10;
 
     // Private member functions
-    void SpawnWord();
-    void ResetGame();
-    void LoadWordsFromFile(const std::string& filename);
-    void UpdateWordTyping(char typed);
-    void CreateCloudShape(FallingWord& word);
+    void ResetGame(unsigned int seed);
+    static std::vector<std::string> LoadWordsFromFile(const std::string& filename);
     void CreatePopEffect(float x, float y, Color color);
-    void UpdateParticles();
-    void UpdateCombo();
+    void UpdateParticles(float dt);
+    void EndGame();
     void SaveHighScore();
     void LoadHighScores();  // Changed from LoadHighScore to LoadHighScores
+    void CacheLeaderboard();
+    void RefreshLeaderboard();
+    void PollLeaderboardRefresh();
     void InitializeTheme();
 
 public:
     // Changed constructor to accept username parameter
     explicit FallingWordsGame(const std::string& username);
     void StartGame();
+    void StartGame(unsigned int gameSeed);  // Replays the game of this seed
     void UpdateGame();
     void DrawGame(bool beginEnd = false);
     void HandleClick(int x, int y);
@@ -0,0 +1,76 @@
+#include "GapBuffer.h"
+#include <algorithm>
+#include <cstring>
+
+void GapBuffer::moveGap(size_t position) {
+    if (position < gapStart) {
+        // Shift the text between the position and the gap to after the gap
+        size_t count = gapStart - position;
+        std::memmove(buffer.data() + gapEnd - count, buffer.data() + position, count);
+        gapStart -= count;
+        gapEnd -= count;
+    }
+    else if (position > gapStart) {
+        size_t count = position - gapStart;
+        std::memmove(buffer.data() + gapStart, buffer.data() + gapEnd, count);
+        gapStart += count;
+        gapEnd += count;
+    }
+}
+
+void GapBuffer::growGap(size_t needed) {
+    if (gapLength() >= needed) return;
+
+    // Doubling keeps a run of inserts amortized constant time
+    size_t tail = buffer.size() - gapEnd;
+    size_t newSize = std::max(buffer.size() * 2, length() + needed + 64);
+    buffer.resize(newSize);
+    std::memmove(buffer.data() + newSize - tail, buffer.data() + gapEnd, tail);
+    gapEnd = newSize - tail;
+}
+
+void GapBuffer::insert(size_t position, std::string_view text) {
+    position = std::min(position, length());
+    moveGap(position);
+    growGap(text.length());
+    std::memcpy(buffer.data() + gapStart, text.data(), text.length());
+    gapStart += text.length();
+}
+
+void GapBuffer::erase(size_t position, size_t count) {
+    if (position >= length()) return;
+    count = std::min(count, length() - position);
+
+    moveGap(position);
+    gapEnd += count;
+}
+
+void GapBuffer::clear() {
+    gapStart = 0;
+    gapEnd = buffer.size();
+}
+
+size_t GapBuffer::copy(char* dest, size_t count, size_t position) const {
+    if (position >= length()) return 0;
+    count = std::min(count, length() - position);
+
+    size_t end = position + count;
+    size_t copied = 0;
+    if (position < gapStart) {
+        copied = std::min(end, gapStart) - position;
+        std::memcpy(dest, buffer.data() + position, copied);
+    }
+    if (end > gapStart) {
+        size_t from = std::max(position, gapStart);
+        std::memcpy(dest + copied, buffer.data() + from + gapLength(), end - from);
+    }
+    return count;
+}
+
+std::string GapBuffer::substr(size_t position, size_t count) const {
+    if (position >= length()) return std::string();
+
+    std::string text(std::min(count, length() - position), '\0');
+    copy(text.data(), text.length(), position);
+    return text;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Text with a movable gap at the last edit. Edits move the gap to where they
+// happen and then fill or widen it, so typing and deleting next to the
+// cursor cost the same however long the text is.
+class GapBuffer {
+public:
+    size_t length() const { return buffer.size() - gapLength(); }
+    bool empty() const { return length() == 0; }
+
+    char operator[](size_t index) const {
+        return buffer[index < gapStart ? index : index + gapLength()];
+    }
+
+    void insert(size_t position, std::string_view text);
+    void insert(size_t position, char c) { insert(position, std::string_view(&c, 1)); }
+    void erase(size_t position, size_t count);
+    void clear();
+
+    // Like std::string::copy: up to count characters from position into
+    // dest, unterminated; returns how many were copied
+    size_t copy(char* dest, size_t count, size_t position) const;
+    std::string substr(size_t position, size_t count) const;
+    std::string str() const { return substr(0, length()); }
+
+private:
+    std::vector<char> buffer;
+    size_t gapStart = 0;
+    size_t gapEnd = 0;
+
+    size_t gapLength() const { return gapEnd - gapStart; }
+    void moveGap(size_t position);
+    void growGap(size_t needed);
+};
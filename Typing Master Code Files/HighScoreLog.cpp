@@ -0,0 +1,81 @@
+#include "HighScoreLog.h"
+#include "MappedFile.h"
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+HighScoreLog::HighScoreLog(const std::string& path) :
+    path(path),
+    lockPath(path + ".lock") {
+}
+
+std::map<std::string, int> HighScoreLog::merge(size_t& lineCount) const {
+    std::map<std::string, int> scores;
+    std::ifstream file(path);
+    std::string line, username;
+    int score;
+    lineCount = 0;
+
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        if (iss >> username >> score) {
+            auto inserted = scores.emplace(username, score);
+            if (!inserted.second && score > inserted.first->second) {
+                inserted.first->second = score;
+            }
+            lineCount++;
+        }
+    }
+    return scores;
+}
+
+std::map<std::string, int> HighScoreLog::load() {
+    // Held while reading so a compaction can't swap the file out underneath
+    FileLock lock(lockPath);
+
+    size_t lineCount = 0;
+    std::map<std::string, int> scores = merge(lineCount);
+
+    if (lock.isLocked() && lineCount > COMPACT_FACTOR * scores.size() + 16) {
+        compact(scores);
+    }
+    return scores;
+}
+
+bool HighScoreLog::append(const std::map<std::string, int>& scores, bool syncToDisk) {
+    if (scores.empty()) return true;
+
+    // Only this file's lock; history writers never wait on it
+    FileLock lock(lockPath);
+    if (!lock.isLocked()) return false;
+
+    {
+        std::ofstream file(path, std::ios::app);
+        if (!file.is_open()) return false;
+        for (const auto& pair : scores) {
+            file << pair.first << " " << pair.second << "\n";
+        }
+        if (!file) return false;
+    }
+    return !syncToDisk || syncFile(path);
+}
+
+bool HighScoreLog::compact(const std::map<std::string, int>& scores) {
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::trunc);
+        if (!file.is_open()) return false;
+        for (const auto& pair : scores) {
+            file << pair.first << " " << pair.second << "\n";
+        }
+        if (!file) return false;
+    }
+
+    // The old log stays in place until the compacted one is on disk and
+    // swapped over it in one step, so a crash at any point keeps one of them
+    if (!syncFile(tempPath) || !replaceFile(tempPath, path)) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <map>
+#include <string>
+
+// highscores.txt as an append-only log of "username score" lines. Writers
+// only ever add a line, so concurrent games can't overwrite each other;
+// readers merge the log by keeping each user's best score.
+class HighScoreLog {
+public:
+    explicit HighScoreLog(const std::string& path = "highscores.txt");
+
+    std::map<std::string, int> load();
+    bool append(const std::map<std::string, int>& scores, bool syncToDisk);
+
+private:
+    // Rewrite the log with one line per user once it is this many times
+    // longer than it needs to be
+    static constexpr size_t COMPACT_FACTOR = 4;
+
+    std::string path;
+    std::string lockPath;
+
+    std::map<std::string, int> merge(size_t& lineCount) const;
+    bool compact(const std::map<std::string, int>& scores);
+};
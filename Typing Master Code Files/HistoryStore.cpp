@@ -0,0 +1,862 @@
+#include "HistoryStore.h"
+#include "MappedFile.h"
+#include "LegacyHistoryParser.h"
+#include <fstream>
+#include <cstring>
+#include <cstddef>
+#include <cstdio>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <map>
+
+namespace {
+    const char HISTORY_MAGIC[4] = { 'T', 'M', 'H', 'S' };
+    const char INDEX_MAGIC[4] = { 'T', 'M', 'H', 'I' };
+    const char SEGMENT_MAGIC[4] = { 'T', 'M', 'S', 'G' };
+
+    // Record layout written by the first version of the store, before
+    // records were chained per user
+    struct HistoryRecordV1 {
+        char username[HistoryStore::USERNAME_SIZE];
+        char date[HistoryStore::DATE_SIZE];
+        int32_t wpm;
+        float accuracy;
+        int32_t duration;
+        int32_t difficulty;
+    };
+
+    void copyField(char* dest, size_t destSize, std::string_view src) {
+        std::memset(dest, 0, destSize);
+        std::memcpy(dest, src.data(), std::min(src.length(), destSize - 1));
+    }
+
+    std::string readField(const char* src, size_t srcSize) {
+        return std::string(src, strnlen(src, srcSize));
+    }
+
+    bool readSegmentHeader(const char* data, size_t size, HistoryStore::SegmentHeader& header) {
+        if (data == nullptr || size < sizeof(header)) return false;
+        std::memcpy(&header, data, sizeof(header));
+        return std::memcmp(header.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) == 0 &&
+            header.version == HistoryStore::SEGMENT_VERSION &&
+            size >= sizeof(header) + header.userCount * sizeof(HistoryStore::SegmentUser) +
+            static_cast<size_t>(header.recordCount) * sizeof(HistoryStore::SegmentRecord);
+    }
+
+    uint64_t hashName(const char* username) {
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < HistoryStore::USERNAME_SIZE && username[i] != '\0'; i++) {
+            hash ^= static_cast<unsigned char>(username[i]);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    bool validIndexHeader(const HistoryStore::IndexHeader& header, uint64_t fileSize) {
+        return std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+            header.version == HistoryStore::INDEX_VERSION &&
+            header.capacity > 0 && (header.capacity & (header.capacity - 1)) == 0 &&
+            header.entryCount < header.capacity &&
+            fileSize == sizeof(header) + static_cast<uint64_t>(header.capacity) * sizeof(HistoryStore::IndexEntry);
+    }
+
+    uint64_t slotOffset(uint32_t slot) {
+        return sizeof(HistoryStore::IndexHeader) + static_cast<uint64_t>(slot) * sizeof(HistoryStore::IndexEntry);
+    }
+
+    // Linear probing from the name's home slot until it or an empty slot
+    bool findSlot(const char* slots, uint32_t capacity, const char* username, HistoryStore::IndexEntry& entry) {
+        uint32_t mask = capacity - 1;
+        uint32_t slot = static_cast<uint32_t>(hashName(username)) & mask;
+        for (uint32_t probes = 0; probes < capacity; probes++) {
+            std::memcpy(&entry, slots + static_cast<size_t>(slot) * sizeof(entry), sizeof(entry));
+            if (entry.totalTests == 0) return false;
+            if (std::strncmp(entry.username, username, HistoryStore::USERNAME_SIZE) == 0) return true;
+            slot = (slot + 1) & mask;
+        }
+        return false;
+    }
+
+    // The index opened by a writer to change a few entries in place.
+    // Entries are read as they're looked up, and commit() writes back only
+    // the ones that changed.
+    class IndexTable {
+    public:
+        // False unless the index describes exactly this history and has
+        // room for newUsers more entries
+        bool open(const std::string& indexPath, uint32_t coveredRecords, uint32_t sealedSegments, size_t newUsers) {
+            path = indexPath;
+            file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+            if (!file.is_open() || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+            file.seekg(0, std::ios::end);
+            uint64_t size = static_cast<uint64_t>(file.tellg());
+            return validIndexHeader(header, size) && header.coveredRecords == coveredRecords &&
+                header.sealedSegments == sealedSegments &&
+                (header.entryCount + static_cast<uint64_t>(newUsers)) * 4 <= static_cast<uint64_t>(header.capacity) * 3;
+        }
+
+        void close() {
+            file.close();
+            changed.clear();
+        }
+
+        // The user's entry, added if the user is new; null on a read error
+        HistoryStore::IndexEntry* entry(const char* username) {
+            uint32_t mask = header.capacity - 1;
+            uint32_t slot = static_cast<uint32_t>(hashName(username)) & mask;
+            HistoryStore::IndexEntry candidate;
+            for (uint32_t probes = 0; probes < header.capacity; probes++) {
+                // Slots taken earlier in this batch aren't on disk yet
+                auto pending = changed.find(slot);
+                if (pending != changed.end()) {
+                    if (std::strncmp(pending->second.username, username, HistoryStore::USERNAME_SIZE) == 0) {
+                        return &pending->second;
+                    }
+                }
+                else {
+                    file.seekg(slotOffset(slot));
+                    if (!file.read(reinterpret_cast<char*>(&candidate), sizeof(candidate))) return nullptr;
+                    if (candidate.totalTests == 0) {
+                        HistoryStore::IndexEntry& added = changed[slot];
+                        added = {};
+                        std::memcpy(added.username, username, HistoryStore::USERNAME_SIZE);
+                        added.lastRecord = HistoryStore::NO_RECORD;
+                        header.entryCount++;
+                        return &added;
+                    }
+                    if (std::strncmp(candidate.username, username, HistoryStore::USERNAME_SIZE) == 0) {
+                        return &(changed[slot] = candidate);
+                    }
+                }
+                slot = (slot + 1) & mask;
+            }
+            return nullptr;
+        }
+
+        // Readers check the header before and after reading an entry, so
+        // it is marked before any entry changes and only then set to the
+        // new record count. If this fails or the process dies part way,
+        // the mark stays and the next access rebuilds the index.
+        bool commit(uint32_t coveredRecords, bool syncToDisk) {
+            HistoryStore::IndexHeader marked = header;
+            marked.coveredRecords = HistoryStore::NO_RECORD;
+            file.seekp(0);
+            file.write(reinterpret_cast<const char*>(&marked), sizeof(marked));
+            file.flush();
+
+            for (const auto& pair : changed) {
+                file.seekp(slotOffset(pair.first));
+                file.write(reinterpret_cast<const char*>(&pair.second), sizeof(pair.second));
+            }
+            file.flush();
+            if (!file || (syncToDisk && !syncFile(path))) return false;
+
+            header.coveredRecords = coveredRecords;
+            file.seekp(0);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.close();
+            return file && (!syncToDisk || syncFile(path));
+        }
+
+    private:
+        std::string path;
+        std::fstream file;
+        HistoryStore::IndexHeader header = {};
+        std::map<uint32_t, HistoryStore::IndexEntry> changed;  // By slot
+    };
+
+    HistoryStore::UserSummary summarize(uint32_t count, int32_t bestWpm, int64_t totalWpm, double totalAccuracy) {
+        HistoryStore::UserSummary summary;
+        if (count == 0) return summary;
+        summary.totalTests = static_cast<int>(count);
+        summary.bestWPM = bestWpm;
+        summary.avgWPM = static_cast<float>(totalWpm) / count;
+        summary.avgAccuracy = static_cast<float>(totalAccuracy / count);
+        return summary;
+    }
+}
+
+HistoryStore::HistoryStore(const std::string& path, const std::string& legacyPath) :
+    path(path),
+    indexPath(path + ".idx"),
+    lockPath(path + ".lock") {
+
+    // Quick check without the lock; nearly every open finds a current file
+    {
+        std::ifstream existing(path, std::ios::binary);
+        HistoryHeader header = {};
+        if (existing.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+            std::memcmp(header.magic, HISTORY_MAGIC, sizeof(HISTORY_MAGIC)) == 0 && header.version == VERSION) {
+            return;
+        }
+    }
+
+    FileLock lock(lockPath);
+
+    // Migrate the old text history the first time the binary store is used
+    std::ifstream existing(path, std::ios::binary);
+    if (!existing.is_open()) {
+        std::ifstream legacy(legacyPath);
+        if (legacy.is_open()) {
+            legacy.close();
+            convertLegacy(legacyPath, path);
+        }
+        return;
+    }
+
+    HistoryHeader header = {};
+    existing.read(reinterpret_cast<char*>(&header), sizeof(header));
+    existing.close();
+    if (std::memcmp(header.magic, HISTORY_MAGIC, sizeof(HISTORY_MAGIC)) == 0 && header.version == 1) {
+        upgradeVersion1(path);
+    }
+}
+
+bool HistoryStore::writeHeader(std::ostream& out, uint32_t sealedSegments) {
+    HistoryHeader header = {};
+    std::memcpy(header.magic, HISTORY_MAGIC, sizeof(HISTORY_MAGIC));
+    header.version = VERSION;
+    header.recordSize = sizeof(HistoryRecord);
+    header.sealedSegments = sealedSegments;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return out.good();
+}
+
+uint32_t HistoryStore::headerVersion(const char* data, size_t size) {
+    if (data == nullptr || size < sizeof(HistoryHeader)) return 0;
+
+    HistoryHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, HISTORY_MAGIC, sizeof(HISTORY_MAGIC)) != 0) return 0;
+    if (header.version == VERSION && header.recordSize != sizeof(HistoryRecord)) return 0;
+    return header.version;
+}
+
+uint32_t HistoryStore::recordCount(const char* data, size_t size) {
+    if (headerVersion(data, size) != VERSION) return 0;
+    return static_cast<uint32_t>((size - sizeof(HistoryHeader)) / sizeof(HistoryRecord));
+}
+
+uint32_t HistoryStore::sealedSegments(const char* data, size_t size) {
+    if (headerVersion(data, size) != VERSION) return 0;
+
+    HistoryHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    return header.sealedSegments;
+}
+
+std::string HistoryStore::segmentPath(uint32_t segment) const {
+    return path + "." + std::to_string(segment);
+}
+
+HistoryStore::HistoryRecord HistoryStore::toDisk(const TypingRecord& record) {
+    HistoryRecord disk = {};
+    copyField(disk.username, USERNAME_SIZE, record.username);
+    copyField(disk.date, DATE_SIZE, record.date);
+    disk.wpm = record.wpm;
+    disk.accuracy = record.accuracy;
+    disk.duration = record.duration;
+    disk.difficulty = record.difficulty;
+    disk.previousRecord = NO_RECORD;
+    return disk;
+}
+
+TypingRecord HistoryStore::fromDisk(const HistoryRecord& disk) {
+    TypingRecord record;
+    record.username = readField(disk.username, USERNAME_SIZE);
+    record.date = readField(disk.date, DATE_SIZE);
+    record.wpm = disk.wpm;
+    record.accuracy = disk.accuracy;
+    record.duration = disk.duration;
+    record.difficulty = disk.difficulty;
+    return record;
+}
+
+bool HistoryStore::append(const TypingRecord& record) {
+    return append(std::vector<TypingRecord>{ record }, false);
+}
+
+bool HistoryStore::append(const std::vector<TypingRecord>& records, bool syncToDisk) {
+    if (records.empty()) return true;
+
+    // Appends from every process go through the history lock, so record
+    // numbers and per-user links can't be handed out twice
+    FileLock lock(lockPath);
+    if (!lock.isLocked()) return false;
+
+    // Only filled when the whole index has to be rewritten
+    UserIndex index;
+    IndexTable table;
+    uint32_t count = 0;
+    uint32_t sealed = 0;
+    bool rewriteIndex = false;
+    bool rolledOver = false;
+    {
+        MappedFile existing;
+        if (existing.open(path)) {
+            if (headerVersion(existing.data(), existing.size()) != VERSION) return false;
+            count = recordCount(existing.data(), existing.size());
+            sealed = sealedSegments(existing.data(), existing.size());
+        }
+
+        if (count > 0 && shouldRollOver(existing.data(), existing.size())) {
+            // Sealing groups every user's records, so it needs every entry
+            currentIndex(index, existing.data(), existing.size(), true);
+            if (!sealActiveSegment(existing.data(), existing.size(), index)) return false;
+            rolledOver = true;
+        }
+        else if (!table.open(indexPath, count, sealed, records.size())) {
+            // Missing, stale, or too full for the batch's new users
+            table.close();
+            if (!loadIndex(index) || index.coveredRecords != count || index.sealedSegments != sealed) {
+                rebuildIndex(index, existing.data(), existing.size());
+            }
+            rewriteIndex = true;
+        }
+    }
+
+    if (rolledOver) {
+        // Swap in an empty active segment; readers still mapping the old
+        // file keep their view of it
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream fresh(tempPath, std::ios::binary | std::ios::trunc);
+            if (!fresh.is_open() || !writeHeader(fresh, index.sealedSegments)) return false;
+        }
+        if (!replaceFile(tempPath, path)) return false;
+
+        count = 0;
+        sealed = index.sealedSegments;
+        index.coveredRecords = 0;
+        for (auto& pair : index.entries) {
+            pair.second.lastRecord = NO_RECORD;
+            pair.second.recordCount = 0;
+        }
+        rewriteIndex = true;
+    }
+
+    if (rewriteIndex && (!saveIndex(index, records.size()) || !table.open(indexPath, count, sealed, records.size()))) {
+        return false;
+    }
+
+    // Link the whole batch up front so it goes out in a single write
+    std::vector<HistoryRecord> batch;
+    batch.reserve(records.size());
+    for (const TypingRecord& record : records) {
+        HistoryRecord disk = toDisk(record);
+        IndexEntry* entry = table.entry(disk.username);
+        if (entry == nullptr) return false;
+        disk.previousRecord = entry->lastRecord;
+        addToEntry(*entry, count + static_cast<uint32_t>(batch.size()), disk);
+        batch.push_back(disk);
+    }
+
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file.is_open()) {
+        std::ofstream create(path, std::ios::binary);
+        create.close();
+        file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+        if (!file.is_open()) return false;
+    }
+
+    // A new file starts with the header
+    if (count == 0) {
+        file.seekp(0);
+        if (!writeHeader(file, sealed)) return false;
+    }
+
+    // Write right after the last whole record, over any torn tail left by
+    // a writer that died mid-append
+    file.seekp(sizeof(HistoryHeader) + static_cast<std::streamoff>(count) * sizeof(HistoryRecord));
+    file.write(reinterpret_cast<const char*>(batch.data()), batch.size() * sizeof(HistoryRecord));
+    file.close();
+    if (!file) return false;
+    if (syncToDisk && !syncFile(path)) return false;
+
+    // The records are saved either way; an index left marked by a failed
+    // update no longer matches the history and is rebuilt on next use
+    table.commit(count + static_cast<uint32_t>(batch.size()), syncToDisk);
+    return true;
+}
+
+std::vector<TypingRecord> HistoryStore::loadUser(const std::string& username) const {
+    std::vector<TypingRecord> records;
+    if (username.length() >= USERNAME_SIZE) return records;
+
+    MappedFile file;
+    if (!file.open(path) || headerVersion(file.data(), file.size()) != VERSION) return records;
+
+    IndexEntry entry;
+    if (!findUser(file.data(), file.size(), username, entry)) return records;
+
+    // Walk the user's chain from the newest record back to the oldest
+    const char* base = file.data() + sizeof(HistoryHeader);
+    uint32_t count = recordCount(file.data(), file.size());
+    uint32_t current = entry.lastRecord;
+    HistoryRecord disk;
+
+    records.reserve(entry.recordCount);
+    while (current < count && records.size() < entry.recordCount) {
+        std::memcpy(&disk, base + static_cast<size_t>(current) * sizeof(HistoryRecord), sizeof(disk));
+        records.push_back(fromDisk(disk));
+
+        // Links always point backwards; anything else means a damaged file
+        if (disk.previousRecord >= current) break;
+        current = disk.previousRecord;
+    }
+
+    // Then the newest sealed segments, where the user's records sit together
+    uint32_t sealed = sealedSegments(file.data(), file.size());
+    for (uint32_t segment = sealed; segment > 0 && sealed - segment < DETAIL_SEGMENTS; segment--) {
+        MappedFile segmentFile;
+        SegmentUser user;
+        if (!segmentFile.open(segmentPath(segment)) ||
+            !findSegmentUser(segmentFile.data(), segmentFile.size(), username, user)) {
+            continue;
+        }
+
+        SegmentHeader header;
+        readSegmentHeader(segmentFile.data(), segmentFile.size(), header);
+        if (static_cast<uint64_t>(user.firstRecord) + user.recordCount > header.recordCount) continue;
+
+        const char* segmentBase = segmentFile.data() + sizeof(SegmentHeader) + header.userCount * sizeof(SegmentUser);
+        SegmentRecord sealedRecord;
+        for (uint32_t i = 0; i < user.recordCount; i++) {
+            std::memcpy(&sealedRecord, segmentBase + static_cast<size_t>(user.firstRecord + i) * sizeof(SegmentRecord),
+                sizeof(sealedRecord));
+
+            TypingRecord record;
+            record.username = username;
+            record.date = readField(sealedRecord.date, DATE_SIZE);
+            record.wpm = sealedRecord.wpm;
+            record.accuracy = sealedRecord.accuracy;
+            record.duration = sealedRecord.duration;
+            record.difficulty = sealedRecord.difficulty;
+            records.push_back(record);
+        }
+    }
+
+    return records;
+}
+
+std::vector<HistoryStore::SegmentSummary> HistoryStore::loadArchivedSummaries(const std::string& username) const {
+    std::vector<SegmentSummary> summaries;
+    if (username.length() >= USERNAME_SIZE) return summaries;
+
+    uint32_t sealed = 0;
+    {
+        std::ifstream file(path, std::ios::binary);
+        HistoryHeader header = {};
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            headerVersion(reinterpret_cast<const char*>(&header), sizeof(header)) != VERSION) {
+            return summaries;
+        }
+        sealed = header.sealedSegments;
+    }
+
+    // Segments past the detailed ones only contribute their summary rows
+    for (uint32_t segment = sealed > DETAIL_SEGMENTS ? sealed - DETAIL_SEGMENTS : 0; segment > 0; segment--) {
+        MappedFile segmentFile;
+        SegmentUser user;
+        if (!segmentFile.open(segmentPath(segment)) ||
+            !findSegmentUser(segmentFile.data(), segmentFile.size(), username, user)) {
+            continue;
+        }
+
+        SegmentSummary summary;
+        summary.firstDate = readField(user.firstDate, DATE_SIZE);
+        summary.lastDate = readField(user.lastDate, DATE_SIZE);
+        summary.stats = summarize(user.recordCount, user.bestWpm, user.totalWpm, user.totalAccuracy);
+        summaries.push_back(summary);
+    }
+    return summaries;
+}
+
+HistoryStore::UserSummary HistoryStore::loadSummary(const std::string& username) const {
+    UserSummary summary;
+    if (username.length() >= USERNAME_SIZE) return summary;
+
+    // Mapping is only needed to check the index is current, the records
+    // themselves are not read unless the index has to be rebuilt
+    MappedFile file;
+    if (!file.open(path) || headerVersion(file.data(), file.size()) != VERSION) return summary;
+
+    IndexEntry entry;
+    if (!findUser(file.data(), file.size(), username, entry)) return summary;
+    return summarize(entry.totalTests, entry.bestWpm, entry.totalWpm, entry.totalAccuracy);
+}
+
+bool HistoryStore::findUser(const char* data, size_t size, const std::string& username, IndexEntry& entry) const {
+    uint32_t count = recordCount(data, size);
+    uint32_t sealed = sealedSegments(data, size);
+    char key[USERNAME_SIZE];
+    copyField(key, USERNAME_SIZE, username);
+
+    // Nearly always the index matches our mapping and only the user's own
+    // slots are read
+    {
+        MappedFile file;
+        IndexHeader before;
+        if (file.open(indexPath) && file.size() >= sizeof(before)) {
+            std::memcpy(&before, file.data(), sizeof(before));
+            if (validIndexHeader(before, file.size()) && before.coveredRecords == count &&
+                before.sealedSegments == sealed) {
+                bool found = findSlot(file.data() + sizeof(before), before.capacity, key, entry);
+
+                // A writer marks the header before changing any entry, so
+                // an unchanged header means the entry wasn't half-written
+                std::atomic_thread_fence(std::memory_order_acquire);
+                IndexHeader after;
+                std::memcpy(&after, file.data(), sizeof(after));
+                if (after.coveredRecords == before.coveredRecords && after.sealedSegments == before.sealedSegments) {
+                    return found;
+                }
+            }
+        }
+    }
+
+    // Missing, stale or being updated: load or rebuild the whole index
+    UserIndex index;
+    currentIndex(index, data, size, false);
+    auto it = index.entries.find(readField(key, USERNAME_SIZE));
+    if (it == index.entries.end()) return false;
+    entry = it->second;
+    return true;
+}
+
+bool HistoryStore::loadIndex(UserIndex& index) const {
+    MappedFile file;
+    IndexHeader header;
+    if (!file.open(indexPath) || file.size() < sizeof(header)) return false;
+    std::memcpy(&header, file.data(), sizeof(header));
+
+    // A marked index was left mid-update and can't be trusted
+    if (!validIndexHeader(header, file.size()) || header.coveredRecords == NO_RECORD) return false;
+
+    index.entries.clear();
+    index.entries.reserve(header.entryCount);
+    IndexEntry entry;
+    for (uint32_t slot = 0; slot < header.capacity; slot++) {
+        std::memcpy(&entry, file.data() + slotOffset(slot), sizeof(entry));
+        if (entry.totalTests > 0) index.entries[readField(entry.username, USERNAME_SIZE)] = entry;
+    }
+    index.coveredRecords = header.coveredRecords;
+    index.sealedSegments = header.sealedSegments;
+    return true;
+}
+
+bool HistoryStore::saveIndex(const UserIndex& index, size_t extraUsers) const {
+    uint32_t capacity = MIN_INDEX_CAPACITY;
+    while (capacity < (index.entries.size() + extraUsers) * 2) capacity *= 2;
+
+    std::vector<IndexEntry> slots(capacity, IndexEntry());
+    uint32_t mask = capacity - 1;
+    for (const auto& pair : index.entries) {
+        uint32_t slot = static_cast<uint32_t>(hashName(pair.second.username)) & mask;
+        while (slots[slot].totalTests > 0) slot = (slot + 1) & mask;
+        slots[slot] = pair.second;
+    }
+
+    IndexHeader header = {};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = INDEX_VERSION;
+    header.coveredRecords = index.coveredRecords;
+    header.entryCount = static_cast<uint32_t>(index.entries.size());
+    header.sealedSegments = index.sealedSegments;
+    header.capacity = capacity;
+
+    // Written beside the index and swapped in whole, so neither a crash nor
+    // a reader outside the lock ever sees a half-written one. Callers hold
+    // the history lock, so the temporary name is never shared.
+    std::string tempPath = indexPath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(slots.data()), slots.size() * sizeof(IndexEntry));
+        if (!file) {
+            file.close();
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+    return syncFile(tempPath) && replaceFile(tempPath, indexPath);
+}
+
+void HistoryStore::rebuildIndex(UserIndex& index, const char* data, size_t size) const {
+    index.entries.clear();
+    index.coveredRecords = recordCount(data, size);
+    index.sealedSegments = sealedSegments(data, size);
+
+    // Totals from sealed segments come straight from their summary tables
+    for (uint32_t segment = 1; segment <= index.sealedSegments; segment++) {
+        MappedFile segmentFile;
+        SegmentHeader header;
+        if (!segmentFile.open(segmentPath(segment)) ||
+            !readSegmentHeader(segmentFile.data(), segmentFile.size(), header)) {
+            continue;
+        }
+
+        SegmentUser user;
+        for (uint32_t i = 0; i < header.userCount; i++) {
+            std::memcpy(&user, segmentFile.data() + sizeof(SegmentHeader) + i * sizeof(SegmentUser), sizeof(user));
+            IndexEntry& entry = entryFor(index, user.username);
+            entry.totalTests += user.recordCount;
+            entry.bestWpm = std::max(entry.bestWpm, user.bestWpm);
+            entry.totalWpm += user.totalWpm;
+            entry.totalAccuracy += user.totalAccuracy;
+        }
+    }
+
+    const char* base = data + sizeof(HistoryHeader);
+    HistoryRecord disk;
+    for (uint32_t i = 0; i < index.coveredRecords; i++) {
+        std::memcpy(&disk, base + static_cast<size_t>(i) * sizeof(HistoryRecord), sizeof(disk));
+        addToEntry(entryFor(index, disk.username), i, disk);
+    }
+}
+
+HistoryStore::IndexEntry& HistoryStore::entryFor(UserIndex& index, const char* username) {
+    auto inserted = index.entries.emplace(readField(username, USERNAME_SIZE), IndexEntry());
+    IndexEntry& entry = inserted.first->second;
+    if (inserted.second) {
+        std::memcpy(entry.username, username, USERNAME_SIZE);
+        entry.lastRecord = NO_RECORD;
+    }
+    return entry;
+}
+
+void HistoryStore::addToEntry(IndexEntry& entry, uint32_t recordNumber, const HistoryRecord& record) {
+    entry.lastRecord = recordNumber;
+    entry.recordCount++;
+    entry.totalTests++;
+    entry.bestWpm = std::max(entry.bestWpm, record.wpm);
+    entry.totalWpm += record.wpm;
+    entry.totalAccuracy += record.accuracy;
+}
+
+bool HistoryStore::currentIndex(UserIndex& index, const char* data, size_t size, bool lockHeld) const {
+    uint32_t count = recordCount(data, size);
+    uint32_t sealed = sealedSegments(data, size);
+    bool loaded = loadIndex(index);
+    if (loaded && index.sealedSegments == sealed && index.coveredRecords == count) return true;
+
+    // Another process appended or rolled over after our mapping was taken;
+    // our view is older than the index, so use it without writing it back
+    auto indexIsNewer = [&] {
+        return loaded && (index.sealedSegments > sealed ||
+            (index.sealedSegments == sealed && index.coveredRecords > count));
+    };
+    if (indexIsNewer() && !lockHeld) {
+        rebuildIndex(index, data, size);
+        return true;
+    }
+
+    // Missing, damaged or behind the history file
+    if (lockHeld) {
+        rebuildIndex(index, data, size);
+        return saveIndex(index);
+    }
+
+    // A writer may have been updating the index in place; once it is done
+    // the index can be current, or newer than our view
+    FileLock lock(lockPath);
+    loaded = loadIndex(index);
+    if (loaded && index.sealedSegments == sealed && index.coveredRecords == count) return true;
+    bool newer = indexIsNewer();
+    rebuildIndex(index, data, size);
+    if (newer) return true;
+    return lock.isLocked() && saveIndex(index);
+}
+
+bool HistoryStore::findSegmentUser(const char* data, size_t size, const std::string& username, SegmentUser& user) {
+    SegmentHeader header;
+    if (username.length() >= USERNAME_SIZE || !readSegmentHeader(data, size, header)) return false;
+
+    // The user table is sorted by name
+    const char* table = data + sizeof(SegmentHeader);
+    uint32_t low = 0;
+    uint32_t high = header.userCount;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        int order = std::strncmp(table + middle * sizeof(SegmentUser), username.c_str(), USERNAME_SIZE);
+        if (order == 0) {
+            std::memcpy(&user, table + middle * sizeof(SegmentUser), sizeof(user));
+            return true;
+        }
+        if (order < 0) low = middle + 1;
+        else high = middle;
+    }
+    return false;
+}
+
+bool HistoryStore::shouldRollOver(const char* data, size_t size) {
+    uint32_t count = recordCount(data, size);
+    if (count >= MAX_SEGMENT_RECORDS) return true;
+    if (count == 0) return false;
+
+    // Dates are "YYYY-MM-DD HH:MM:SS", so they compare correctly as text
+    auto cutoff = std::chrono::system_clock::now() - std::chrono::hours(24 * MAX_SEGMENT_AGE_DAYS);
+    std::time_t cutoffTime = std::chrono::system_clock::to_time_t(cutoff);
+    struct tm timeinfo;
+#ifdef _WIN32
+    localtime_s(&timeinfo, &cutoffTime);
+#else
+    localtime_r(&cutoffTime, &timeinfo);
+#endif
+    char cutoffDate[DATE_SIZE];
+    std::strftime(cutoffDate, sizeof(cutoffDate), "%Y-%m-%d %H:%M:%S", &timeinfo);
+
+    HistoryRecord first;
+    std::memcpy(&first, data + sizeof(HistoryHeader), sizeof(first));
+    std::string firstDate = readField(first.date, DATE_SIZE);
+    return !firstDate.empty() && firstDate < cutoffDate;
+}
+
+bool HistoryStore::sealActiveSegment(const char* data, size_t size, UserIndex& index) const {
+    // Group the active records by user, in name order, using the index chains
+    std::vector<const IndexEntry*> users;
+    for (const auto& pair : index.entries) {
+        if (pair.second.recordCount > 0) users.push_back(&pair.second);
+    }
+    std::sort(users.begin(), users.end(), [](const IndexEntry* a, const IndexEntry* b) {
+        return std::strncmp(a->username, b->username, USERNAME_SIZE) < 0;
+        });
+
+    std::vector<SegmentUser> table;
+    std::vector<SegmentRecord> records;
+    table.reserve(users.size());
+    records.reserve(recordCount(data, size));
+
+    const char* base = data + sizeof(HistoryHeader);
+    uint32_t count = recordCount(data, size);
+    for (const IndexEntry* entry : users) {
+        SegmentUser user = {};
+        std::memcpy(user.username, entry->username, USERNAME_SIZE);
+        user.firstRecord = static_cast<uint32_t>(records.size());
+
+        HistoryRecord disk;
+        uint32_t current = entry->lastRecord;
+        while (current < count && user.recordCount < entry->recordCount) {
+            std::memcpy(&disk, base + static_cast<size_t>(current) * sizeof(HistoryRecord), sizeof(disk));
+
+            SegmentRecord sealed = {};
+            std::memcpy(sealed.date, disk.date, DATE_SIZE);
+            sealed.wpm = disk.wpm;
+            sealed.accuracy = disk.accuracy;
+            sealed.duration = disk.duration;
+            sealed.difficulty = disk.difficulty;
+            records.push_back(sealed);
+
+            if (user.recordCount == 0) std::memcpy(user.lastDate, disk.date, DATE_SIZE);
+            std::memcpy(user.firstDate, disk.date, DATE_SIZE);
+            user.recordCount++;
+            user.bestWpm = std::max(user.bestWpm, disk.wpm);
+            user.totalWpm += disk.wpm;
+            user.totalAccuracy += disk.accuracy;
+
+            if (disk.previousRecord >= current) break;
+            current = disk.previousRecord;
+        }
+        table.push_back(user);
+    }
+
+    SegmentHeader header = {};
+    std::memcpy(header.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+    header.version = SEGMENT_VERSION;
+    header.userCount = static_cast<uint32_t>(table.size());
+    header.recordCount = static_cast<uint32_t>(records.size());
+
+    uint32_t segment = index.sealedSegments + 1;
+    std::string tempPath = segmentPath(segment) + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(SegmentUser));
+        out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(SegmentRecord));
+        if (!out) return false;
+    }
+    if (!syncFile(tempPath) || !replaceFile(tempPath, segmentPath(segment))) return false;
+
+    index.sealedSegments = segment;
+    return true;
+}
+
+bool HistoryStore::upgradeVersion1(const std::string& path) {
+    std::vector<HistoryRecord> records;
+    {
+        MappedFile file;
+        if (!file.open(path) || file.size() < sizeof(HistoryHeader)) return false;
+
+        std::unordered_map<std::string, uint32_t> lastRecord;
+        const char* cursor = file.data() + sizeof(HistoryHeader);
+        const char* end = file.data() + file.size();
+        HistoryRecordV1 old;
+
+        for (; cursor + sizeof(HistoryRecordV1) <= end; cursor += sizeof(HistoryRecordV1)) {
+            std::memcpy(&old, cursor, sizeof(old));
+
+            HistoryRecord disk = {};
+            std::memcpy(disk.username, old.username, USERNAME_SIZE);
+            std::memcpy(disk.date, old.date, DATE_SIZE);
+            disk.wpm = old.wpm;
+            disk.accuracy = old.accuracy;
+            disk.duration = old.duration;
+            disk.difficulty = old.difficulty;
+
+            auto inserted = lastRecord.emplace(readField(old.username, USERNAME_SIZE), NO_RECORD);
+            disk.previousRecord = inserted.first->second;
+            inserted.first->second = static_cast<uint32_t>(records.size());
+            records.push_back(disk);
+        }
+    }
+
+    std::string tempPath = path + ".tmp";
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open() || !writeHeader(out)) return false;
+    out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(HistoryRecord));
+    out.close();
+    if (!out) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    return replaceFile(tempPath, path);
+}
+
+bool HistoryStore::convertLegacy(const std::string& legacyPath, const std::string& path) {
+    // Write to a temporary file so an interrupted conversion is retried next time
+    std::string tempPath = path + ".tmp";
+    std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+    if (!out.is_open() || !writeHeader(out)) return false;
+
+    std::unordered_map<std::string, uint32_t> lastRecord;
+    uint32_t written = 0;
+
+    LegacyHistoryParser parser(legacyPath);
+    bool parsed = parser.parse([&](const LegacyRecord& legacy) {
+        HistoryRecord disk = {};
+        copyField(disk.username, USERNAME_SIZE, legacy.username);
+        copyField(disk.date, DATE_SIZE, legacy.date);
+        disk.wpm = legacy.wpm;
+        disk.accuracy = legacy.accuracy;
+        disk.duration = legacy.duration;
+        disk.difficulty = legacy.difficulty;
+
+        auto inserted = lastRecord.emplace(readField(disk.username, USERNAME_SIZE), NO_RECORD);
+        disk.previousRecord = inserted.first->second;
+        inserted.first->second = written++;
+        out.write(reinterpret_cast<const char*>(&disk), sizeof(disk));
+        });
+
+    out.close();
+    if (!parsed || !out) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return std::rename(tempPath.c_str(), path.c_str()) == 0;
+}
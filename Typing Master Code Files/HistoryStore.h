@@ -0,0 +1,172 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+struct TypingRecord {
+    std::string username;
+    std::string date;
+    int wpm;
+    float accuracy;
+    int duration;
+    int difficulty;
+};
+
+// Fixed-width binary typing history. The file is a HistoryHeader followed by
+// HistoryRecord entries, so it can be memory-mapped and scanned in place.
+// Each record links back to the same user's previous record, and a sidecar
+// index keeps every user's newest record so one user's history can be read
+// without touching anybody else's. The index also carries running totals per
+// user, so summary stats never need the records at all. It is an
+// open-addressing hash table of fixed slots: a lookup probes a few of them,
+// and an append rewrites only the slots of the users in the batch, in place.
+// The whole index is only rewritten when it has to grow or be rebuilt.
+//
+// The file above is only the active segment. Once it grows past
+// MAX_SEGMENT_RECORDS or its oldest result is MAX_SEGMENT_AGE_DAYS old, it
+// is sealed into a compact numbered segment (records grouped by user, with a
+// per-user summary table) and a fresh active segment is started. Only the
+// newest DETAIL_SEGMENTS sealed segments are read record by record; older
+// ones are read from their summary tables alone.
+class HistoryStore {
+public:
+    static constexpr uint32_t VERSION = 2;
+    static constexpr uint32_t INDEX_VERSION = 4;
+    static constexpr uint32_t SEGMENT_VERSION = 1;
+    static constexpr uint32_t MAX_SEGMENT_RECORDS = 50000;
+    static constexpr int MAX_SEGMENT_AGE_DAYS = 90;
+    static constexpr uint32_t DETAIL_SEGMENTS = 1;
+    static constexpr uint32_t NO_RECORD = 0xFFFFFFFFu;
+    static constexpr uint32_t MIN_INDEX_CAPACITY = 256;
+    static constexpr size_t USERNAME_SIZE = 32;
+    static constexpr size_t DATE_SIZE = 20;  // "YYYY-MM-DD HH:MM:SS" + terminator
+
+    struct HistoryHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t recordSize;
+        uint32_t sealedSegments;  // Segments sealed before this one was started
+    };
+
+    struct HistoryRecord {
+        char username[USERNAME_SIZE];
+        char date[DATE_SIZE];
+        int32_t wpm;
+        float accuracy;
+        int32_t duration;
+        int32_t difficulty;
+        uint32_t previousRecord;  // Same user's previous record, or NO_RECORD
+    };
+
+    // Followed by `capacity` IndexEntry slots; capacity is a power of two
+    struct IndexHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t coveredRecords;  // History record count the index was built from, NO_RECORD mid-update
+        uint32_t entryCount;
+        uint32_t sealedSegments;
+        uint32_t capacity;
+    };
+
+    // Running totals cover every segment; lastRecord and recordCount only
+    // describe the user's chain in the active segment. A slot with no
+    // tests is empty.
+    struct IndexEntry {
+        char username[USERNAME_SIZE];
+        uint32_t lastRecord;
+        uint32_t recordCount;
+        int32_t bestWpm;
+        uint32_t totalTests;
+        int64_t totalWpm;
+        double totalAccuracy;
+    };
+
+    struct SegmentHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t userCount;
+        uint32_t recordCount;
+    };
+
+    // Sorted by username; each user's records are stored together, newest first
+    struct SegmentUser {
+        char username[USERNAME_SIZE];
+        uint32_t firstRecord;
+        uint32_t recordCount;
+        int32_t bestWpm;
+        uint32_t reserved;
+        int64_t totalWpm;
+        double totalAccuracy;
+        char firstDate[DATE_SIZE];
+        char lastDate[DATE_SIZE];
+    };
+
+    struct SegmentRecord {
+        char date[DATE_SIZE];
+        int32_t wpm;
+        float accuracy;
+        int32_t duration;
+        int32_t difficulty;
+    };
+
+    struct UserSummary {
+        int totalTests = 0;
+        int bestWPM = 0;
+        float avgWPM = 0;
+        float avgAccuracy = 0;
+    };
+
+    struct SegmentSummary {
+        std::string firstDate;
+        std::string lastDate;
+        UserSummary stats;
+    };
+
+    explicit HistoryStore(const std::string& path = "typing_history.dat",
+        const std::string& legacyPath = "typing_history.txt");
+
+    bool append(const TypingRecord& record);
+    bool append(const std::vector<TypingRecord>& records, bool syncToDisk);
+    // Records from the active segment and the newest sealed ones, newest first
+    std::vector<TypingRecord> loadUser(const std::string& username) const;
+    // One summary per older sealed segment the user appears in, newest first
+    std::vector<SegmentSummary> loadArchivedSummaries(const std::string& username) const;
+    UserSummary loadSummary(const std::string& username) const;
+
+    // One-time import of the old "User:/Date:/WPM:" text blocks
+    static bool convertLegacy(const std::string& legacyPath, const std::string& path);
+
+private:
+    struct UserIndex {
+        uint32_t coveredRecords = 0;
+        uint32_t sealedSegments = 0;
+        std::unordered_map<std::string, IndexEntry> entries;
+    };
+
+    std::string path;
+    std::string indexPath;
+    std::string lockPath;
+
+    static bool writeHeader(std::ostream& out, uint32_t sealedSegments = 0);
+    static uint32_t headerVersion(const char* data, size_t size);
+    static uint32_t recordCount(const char* data, size_t size);
+    static uint32_t sealedSegments(const char* data, size_t size);
+    static HistoryRecord toDisk(const TypingRecord& record);
+    static TypingRecord fromDisk(const HistoryRecord& record);
+    static bool upgradeVersion1(const std::string& path);
+    static IndexEntry& entryFor(UserIndex& index, const char* username);
+    static void addToEntry(IndexEntry& entry, uint32_t recordNumber, const HistoryRecord& record);
+
+    bool loadIndex(UserIndex& index) const;
+    // Rewrites the whole index, at most half full once extraUsers are added
+    bool saveIndex(const UserIndex& index, size_t extraUsers = 0) const;
+    bool findUser(const char* data, size_t size, const std::string& username, IndexEntry& entry) const;
+    void rebuildIndex(UserIndex& index, const char* data, size_t size) const;
+    bool currentIndex(UserIndex& index, const char* data, size_t size, bool lockHeld) const;
+
+    std::string segmentPath(uint32_t segment) const;
+    static bool findSegmentUser(const char* data, size_t size, const std::string& username, SegmentUser& user);
+    static bool shouldRollOver(const char* data, size_t size);
+    bool sealActiveSegment(const char* data, size_t size, UserIndex& index) const;
+};
@@ -0,0 +1,185 @@
+#pragma once
+#include <cstddef>
+#include "raylib.h"
+
+// One key of the on-screen keyboard. raylib names keys by where they sit on
+// a US QWERTY board, so keyCode is the physical key and label is what the
+// layout types with it. Width is in standard key widths.
+struct KeyDef {
+    const char* label;
+    int keyCode;
+    int altKeyCode;  // The right-hand twin of a modifier, or KEY_NULL
+    float width;
+};
+
+struct KeyRow {
+    const KeyDef* keys;
+    size_t count;
+};
+
+struct KeyboardLayout {
+    const char* name;
+    KeyRow rows[5];
+};
+
+constexpr size_t KEYBOARD_ROWS = 5;
+
+template <size_t N>
+constexpr KeyRow keyRow(const KeyDef(&keys)[N]) {
+    return { keys, N };
+}
+
+constexpr float rowUnits(KeyRow row) {
+    float units = 0;
+    for (size_t i = 0; i < row.count; i++) units += row.keys[i].width;
+    return units;
+}
+
+namespace keyboard_rows {
+    constexpr KeyDef BACKSPACE = { "?", KEY_BACKSPACE, KEY_NULL, 2.0f };
+    constexpr KeyDef TAB = { "Tab", KEY_TAB, KEY_NULL, 1.5f };
+    constexpr KeyDef CAPS = { "Caps", KEY_CAPS_LOCK, KEY_NULL, 1.75f };
+    constexpr KeyDef ENTER = { "Enter", KEY_ENTER, KEY_NULL, 2.25f };
+    constexpr KeyDef LEFT_SHIFT = { "Shift", KEY_LEFT_SHIFT, KEY_RIGHT_SHIFT, 2.25f };
+    constexpr KeyDef RIGHT_SHIFT = { "Shift", KEY_RIGHT_SHIFT, KEY_LEFT_SHIFT, 2.25f };
+
+    constexpr KeyDef NUMBERS[] = {
+        { "`", KEY_GRAVE, KEY_NULL, 1 }, { "1", KEY_ONE, KEY_NULL, 1 }, { "2", KEY_TWO, KEY_NULL, 1 },
+        { "3", KEY_THREE, KEY_NULL, 1 }, { "4", KEY_FOUR, KEY_NULL, 1 }, { "5", KEY_FIVE, KEY_NULL, 1 },
+        { "6", KEY_SIX, KEY_NULL, 1 }, { "7", KEY_SEVEN, KEY_NULL, 1 }, { "8", KEY_EIGHT, KEY_NULL, 1 },
+        { "9", KEY_NINE, KEY_NULL, 1 }, { "0", KEY_ZERO, KEY_NULL, 1 }, { "-", KEY_MINUS, KEY_NULL, 1 },
+        { "=", KEY_EQUAL, KEY_NULL, 1 }, BACKSPACE
+    };
+    constexpr KeyDef BOTTOM[] = {
+        { "Ctrl", KEY_LEFT_CONTROL, KEY_RIGHT_CONTROL, 1.25f }, { "Win", KEY_LEFT_SUPER, KEY_RIGHT_SUPER, 1.25f },
+        { "Alt", KEY_LEFT_ALT, KEY_RIGHT_ALT, 1.25f }, { "Space", KEY_SPACE, KEY_NULL, 6.25f },
+        { "Alt", KEY_RIGHT_ALT, KEY_LEFT_ALT, 1.25f }, { "Fn", KEY_NULL, KEY_NULL, 1.25f },
+        { "Menu", KEY_KB_MENU, KEY_NULL, 1.25f }, { "Ctrl", KEY_RIGHT_CONTROL, KEY_LEFT_CONTROL, 1.25f }
+    };
+
+    constexpr KeyDef QWERTY_TOP[] = {
+        TAB, { "Q", KEY_Q, KEY_NULL, 1 }, { "W", KEY_W, KEY_NULL, 1 }, { "E", KEY_E, KEY_NULL, 1 },
+        { "R", KEY_R, KEY_NULL, 1 }, { "T", KEY_T, KEY_NULL, 1 }, { "Y", KEY_Y, KEY_NULL, 1 },
+        { "U", KEY_U, KEY_NULL, 1 }, { "I", KEY_I, KEY_NULL, 1 }, { "O", KEY_O, KEY_NULL, 1 },
+        { "P", KEY_P, KEY_NULL, 1 }, { "[", KEY_LEFT_BRACKET, KEY_NULL, 1 },
+        { "]", KEY_RIGHT_BRACKET, KEY_NULL, 1 }, { "\\", KEY_BACKSLASH, KEY_NULL, 1 }
+    };
+    constexpr KeyDef QWERTY_HOME[] = {
+        CAPS, { "A", KEY_A, KEY_NULL, 1 }, { "S", KEY_S, KEY_NULL, 1 }, { "D", KEY_D, KEY_NULL, 1 },
+        { "F", KEY_F, KEY_NULL, 1 }, { "G", KEY_G, KEY_NULL, 1 }, { "H", KEY_H, KEY_NULL, 1 },
+        { "J", KEY_J, KEY_NULL, 1 }, { "K", KEY_K, KEY_NULL, 1 }, { "L", KEY_L, KEY_NULL, 1 },
+        { ";", KEY_SEMICOLON, KEY_NULL, 1 }, { "'", KEY_APOSTROPHE, KEY_NULL, 1 }, ENTER
+    };
+    constexpr KeyDef QWERTY_BOTTOM[] = {
+        LEFT_SHIFT, { "Z", KEY_Z, KEY_NULL, 1 }, { "X", KEY_X, KEY_NULL, 1 }, { "C", KEY_C, KEY_NULL, 1 },
+        { "V", KEY_V, KEY_NULL, 1 }, { "B", KEY_B, KEY_NULL, 1 }, { "N", KEY_N, KEY_NULL, 1 },
+        { "M", KEY_M, KEY_NULL, 1 }, { ",", KEY_COMMA, KEY_NULL, 1 }, { ".", KEY_PERIOD, KEY_NULL, 1 },
+        { "/", KEY_SLASH, KEY_NULL, 1 }, RIGHT_SHIFT
+    };
+
+    constexpr KeyDef DVORAK_NUMBERS[] = {
+        { "`", KEY_GRAVE, KEY_NULL, 1 }, { "1", KEY_ONE, KEY_NULL, 1 }, { "2", KEY_TWO, KEY_NULL, 1 },
+        { "3", KEY_THREE, KEY_NULL, 1 }, { "4", KEY_FOUR, KEY_NULL, 1 }, { "5", KEY_FIVE, KEY_NULL, 1 },
+        { "6", KEY_SIX, KEY_NULL, 1 }, { "7", KEY_SEVEN, KEY_NULL, 1 }, { "8", KEY_EIGHT, KEY_NULL, 1 },
+        { "9", KEY_NINE, KEY_NULL, 1 }, { "0", KEY_ZERO, KEY_NULL, 1 }, { "[", KEY_MINUS, KEY_NULL, 1 },
+        { "]", KEY_EQUAL, KEY_NULL, 1 }, BACKSPACE
+    };
+    constexpr KeyDef DVORAK_TOP[] = {
+        TAB, { "'", KEY_Q, KEY_NULL, 1 }, { ",", KEY_W, KEY_NULL, 1 }, { ".", KEY_E, KEY_NULL, 1 },
+        { "P", KEY_R, KEY_NULL, 1 }, { "Y", KEY_T, KEY_NULL, 1 }, { "F", KEY_Y, KEY_NULL, 1 },
+        { "G", KEY_U, KEY_NULL, 1 }, { "C", KEY_I, KEY_NULL, 1 }, { "R", KEY_O, KEY_NULL, 1 },
+        { "L", KEY_P, KEY_NULL, 1 }, { "/", KEY_LEFT_BRACKET, KEY_NULL, 1 },
+        { "=", KEY_RIGHT_BRACKET, KEY_NULL, 1 }, { "\\", KEY_BACKSLASH, KEY_NULL, 1 }
+    };
+    constexpr KeyDef DVORAK_HOME[] = {
+        CAPS, { "A", KEY_A, KEY_NULL, 1 }, { "O", KEY_S, KEY_NULL, 1 }, { "E", KEY_D, KEY_NULL, 1 },
+        { "U", KEY_F, KEY_NULL, 1 }, { "I", KEY_G, KEY_NULL, 1 }, { "D", KEY_H, KEY_NULL, 1 },
+        { "H", KEY_J, KEY_NULL, 1 }, { "T", KEY_K, KEY_NULL, 1 }, { "N", KEY_L, KEY_NULL, 1 },
+        { "S", KEY_SEMICOLON, KEY_NULL, 1 }, { "-", KEY_APOSTROPHE, KEY_NULL, 1 }, ENTER
+    };
+    constexpr KeyDef DVORAK_BOTTOM[] = {
+        LEFT_SHIFT, { ";", KEY_Z, KEY_NULL, 1 }, { "Q", KEY_X, KEY_NULL, 1 }, { "J", KEY_C, KEY_NULL, 1 },
+        { "K", KEY_V, KEY_NULL, 1 }, { "X", KEY_B, KEY_NULL, 1 }, { "B", KEY_N, KEY_NULL, 1 },
+        { "M", KEY_M, KEY_NULL, 1 }, { "W", KEY_COMMA, KEY_NULL, 1 }, { "V", KEY_PERIOD, KEY_NULL, 1 },
+        { "Z", KEY_SLASH, KEY_NULL, 1 }, RIGHT_SHIFT
+    };
+
+    constexpr KeyDef COLEMAK_TOP[] = {
+        TAB, { "Q", KEY_Q, KEY_NULL, 1 }, { "W", KEY_W, KEY_NULL, 1 }, { "F", KEY_E, KEY_NULL, 1 },
+        { "P", KEY_R, KEY_NULL, 1 }, { "G", KEY_T, KEY_NULL, 1 }, { "J", KEY_Y, KEY_NULL, 1 },
+        { "L", KEY_U, KEY_NULL, 1 }, { "U", KEY_I, KEY_NULL, 1 }, { "Y", KEY_O, KEY_NULL, 1 },
+        { ";", KEY_P, KEY_NULL, 1 }, { "[", KEY_LEFT_BRACKET, KEY_NULL, 1 },
+        { "]", KEY_RIGHT_BRACKET, KEY_NULL, 1 }, { "\\", KEY_BACKSLASH, KEY_NULL, 1 }
+    };
+    constexpr KeyDef COLEMAK_HOME[] = {
+        // Colemak puts Backspace where Caps Lock was
+        { "Bksp", KEY_CAPS_LOCK, KEY_NULL, 1.75f }, { "A", KEY_A, KEY_NULL, 1 }, { "R", KEY_S, KEY_NULL, 1 },
+        { "S", KEY_D, KEY_NULL, 1 }, { "T", KEY_F, KEY_NULL, 1 }, { "D", KEY_G, KEY_NULL, 1 },
+        { "H", KEY_H, KEY_NULL, 1 }, { "N", KEY_J, KEY_NULL, 1 }, { "E", KEY_K, KEY_NULL, 1 },
+        { "I", KEY_L, KEY_NULL, 1 }, { "O", KEY_SEMICOLON, KEY_NULL, 1 }, { "'", KEY_APOSTROPHE, KEY_NULL, 1 },
+        ENTER
+    };
+    constexpr KeyDef COLEMAK_BOTTOM[] = {
+        LEFT_SHIFT, { "Z", KEY_Z, KEY_NULL, 1 }, { "X", KEY_X, KEY_NULL, 1 }, { "C", KEY_C, KEY_NULL, 1 },
+        { "V", KEY_V, KEY_NULL, 1 }, { "B", KEY_B, KEY_NULL, 1 }, { "K", KEY_N, KEY_NULL, 1 },
+        { "M", KEY_M, KEY_NULL, 1 }, { ",", KEY_COMMA, KEY_NULL, 1 }, { ".", KEY_PERIOD, KEY_NULL, 1 },
+        { "/", KEY_SLASH, KEY_NULL, 1 }, RIGHT_SHIFT
+    };
+
+    // The default font is ASCII only, so AZERTY keys carry their ASCII
+    // legend: the shifted digits on the number row, % for the u-grave key
+    constexpr KeyDef AZERTY_NUMBERS[] = {
+        { "", KEY_GRAVE, KEY_NULL, 1 }, { "1", KEY_ONE, KEY_NULL, 1 }, { "2", KEY_TWO, KEY_NULL, 1 },
+        { "3", KEY_THREE, KEY_NULL, 1 }, { "4", KEY_FOUR, KEY_NULL, 1 }, { "5", KEY_FIVE, KEY_NULL, 1 },
+        { "6", KEY_SIX, KEY_NULL, 1 }, { "7", KEY_SEVEN, KEY_NULL, 1 }, { "8", KEY_EIGHT, KEY_NULL, 1 },
+        { "9", KEY_NINE, KEY_NULL, 1 }, { "0", KEY_ZERO, KEY_NULL, 1 }, { ")", KEY_MINUS, KEY_NULL, 1 },
+        { "=", KEY_EQUAL, KEY_NULL, 1 }, BACKSPACE
+    };
+    constexpr KeyDef AZERTY_TOP[] = {
+        TAB, { "A", KEY_Q, KEY_NULL, 1 }, { "Z", KEY_W, KEY_NULL, 1 }, { "E", KEY_E, KEY_NULL, 1 },
+        { "R", KEY_R, KEY_NULL, 1 }, { "T", KEY_T, KEY_NULL, 1 }, { "Y", KEY_Y, KEY_NULL, 1 },
+        { "U", KEY_U, KEY_NULL, 1 }, { "I", KEY_I, KEY_NULL, 1 }, { "O", KEY_O, KEY_NULL, 1 },
+        { "P", KEY_P, KEY_NULL, 1 }, { "^", KEY_LEFT_BRACKET, KEY_NULL, 1 },
+        { "$", KEY_RIGHT_BRACKET, KEY_NULL, 1 }, { "*", KEY_BACKSLASH, KEY_NULL, 1 }
+    };
+    constexpr KeyDef AZERTY_HOME[] = {
+        CAPS, { "Q", KEY_A, KEY_NULL, 1 }, { "S", KEY_S, KEY_NULL, 1 }, { "D", KEY_D, KEY_NULL, 1 },
+        { "F", KEY_F, KEY_NULL, 1 }, { "G", KEY_G, KEY_NULL, 1 }, { "H", KEY_H, KEY_NULL, 1 },
+        { "J", KEY_J, KEY_NULL, 1 }, { "K", KEY_K, KEY_NULL, 1 }, { "L", KEY_L, KEY_NULL, 1 },
+        { "M", KEY_SEMICOLON, KEY_NULL, 1 }, { "%", KEY_APOSTROPHE, KEY_NULL, 1 }, ENTER
+    };
+    constexpr KeyDef AZERTY_BOTTOM[] = {
+        LEFT_SHIFT, { "W", KEY_Z, KEY_NULL, 1 }, { "X", KEY_X, KEY_NULL, 1 }, { "C", KEY_C, KEY_NULL, 1 },
+        { "V", KEY_V, KEY_NULL, 1 }, { "B", KEY_B, KEY_NULL, 1 }, { "N", KEY_N, KEY_NULL, 1 },
+        { ",", KEY_M, KEY_NULL, 1 }, { ";", KEY_COMMA, KEY_NULL, 1 }, { ":", KEY_PERIOD, KEY_NULL, 1 },
+        { "!", KEY_SLASH, KEY_NULL, 1 }, RIGHT_SHIFT
+    };
+}
+
+inline constexpr KeyboardLayout KEYBOARD_LAYOUTS[] = {
+    { "QWERTY", { keyRow(keyboard_rows::NUMBERS), keyRow(keyboard_rows::QWERTY_TOP),
+        keyRow(keyboard_rows::QWERTY_HOME), keyRow(keyboard_rows::QWERTY_BOTTOM), keyRow(keyboard_rows::BOTTOM) } },
+    { "Dvorak", { keyRow(keyboard_rows::DVORAK_NUMBERS), keyRow(keyboard_rows::DVORAK_TOP),
+        keyRow(keyboard_rows::DVORAK_HOME), keyRow(keyboard_rows::DVORAK_BOTTOM), keyRow(keyboard_rows::BOTTOM) } },
+    { "Colemak", { keyRow(keyboard_rows::NUMBERS), keyRow(keyboard_rows::COLEMAK_TOP),
+        keyRow(keyboard_rows::COLEMAK_HOME), keyRow(keyboard_rows::COLEMAK_BOTTOM), keyRow(keyboard_rows::BOTTOM) } },
+    { "AZERTY", { keyRow(keyboard_rows::AZERTY_NUMBERS), keyRow(keyboard_rows::AZERTY_TOP),
+        keyRow(keyboard_rows::AZERTY_HOME), keyRow(keyboard_rows::AZERTY_BOTTOM), keyRow(keyboard_rows::BOTTOM) } }
+};
+
+constexpr size_t KEYBOARD_LAYOUT_COUNT = sizeof(KEYBOARD_LAYOUTS) / sizeof(KEYBOARD_LAYOUTS[0]);
+
+// Widest row of a layout, in key widths
+constexpr float layoutUnits(const KeyboardLayout& layout) {
+    float widest = 0;
+    for (size_t row = 0; row < KEYBOARD_ROWS; row++) {
+        float units = rowUnits(layout.rows[row]);
+        if (units > widest) widest = units;
+    }
+    return widest;
+}
+
+// Every layout shares one outline, so switching layouts never moves the keyboard
+static_assert(layoutUnits(KEYBOARD_LAYOUTS[1]) == layoutUnits(KEYBOARD_LAYOUTS[0]), "Dvorak outline differs");
+static_assert(layoutUnits(KEYBOARD_LAYOUTS[2]) == layoutUnits(KEYBOARD_LAYOUTS[0]), "Colemak outline differs");
+static_assert(layoutUnits(KEYBOARD_LAYOUTS[3]) == layoutUnits(KEYBOARD_LAYOUTS[0]), "AZERTY outline differs");
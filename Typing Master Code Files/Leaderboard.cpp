@@ -0,0 +1,160 @@
+#include "Leaderboard.h"
+#include "HighScoreLog.h"
+#include <algorithm>
+
+namespace {
+    bool ranksAbove(const Leaderboard::Entry& a, const Leaderboard::Entry& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.username < b.username;
+    }
+}
+
+Leaderboard& Leaderboard::shared() {
+    static Leaderboard board(HighScoreLog().load());
+    return board;
+}
+
+Leaderboard::Leaderboard(const std::map<std::string, int>& scores) {
+    nodes.reserve(scores.size());
+    bestScores.reserve(scores.size());
+    merge(scores);
+}
+
+void Leaderboard::updateSize(int32_t node) {
+    nodes[node].size = 1 + sizeOf(nodes[node].left) + sizeOf(nodes[node].right);
+}
+
+uint32_t Leaderboard::nextPriority() {
+    // xorshift32; the tree only needs priorities that look random
+    priorityState ^= priorityState << 13;
+    priorityState ^= priorityState >> 17;
+    priorityState ^= priorityState << 5;
+    return priorityState;
+}
+
+void Leaderboard::split(int32_t node, const Entry& entry, int32_t& left, int32_t& right) {
+    if (node == NO_NODE) {
+        left = right = NO_NODE;
+        return;
+    }
+    if (ranksAbove(nodes[node].entry, entry)) {
+        split(nodes[node].right, entry, nodes[node].right, right);
+        left = node;
+    }
+    else {
+        split(nodes[node].left, entry, left, nodes[node].left);
+        right = node;
+    }
+    updateSize(node);
+}
+
+int32_t Leaderboard::join(int32_t left, int32_t right) {
+    if (left == NO_NODE) return right;
+    if (right == NO_NODE) return left;
+    if (nodes[left].priority > nodes[right].priority) {
+        nodes[left].right = join(nodes[left].right, right);
+        updateSize(left);
+        return left;
+    }
+    nodes[right].left = join(left, nodes[right].left);
+    updateSize(right);
+    return right;
+}
+
+void Leaderboard::insert(const Entry& entry) {
+    int32_t node;
+    if (!freeNodes.empty()) {
+        node = freeNodes.back();
+        freeNodes.pop_back();
+    }
+    else {
+        node = static_cast<int32_t>(nodes.size());
+        nodes.emplace_back();
+    }
+    nodes[node] = Node{ entry, nextPriority(), 1, NO_NODE, NO_NODE };
+
+    int32_t left, right;
+    split(root, entry, left, right);
+    root = join(join(left, node), right);
+}
+
+int32_t Leaderboard::erase(int32_t node, const Entry& entry) {
+    if (node == NO_NODE) return NO_NODE;
+    if (ranksAbove(entry, nodes[node].entry)) {
+        nodes[node].left = erase(nodes[node].left, entry);
+    }
+    else if (ranksAbove(nodes[node].entry, entry)) {
+        nodes[node].right = erase(nodes[node].right, entry);
+    }
+    else {
+        freeNodes.push_back(node);
+        return join(nodes[node].left, nodes[node].right);
+    }
+    updateSize(node);
+    return node;
+}
+
+bool Leaderboard::submit(const std::string& username, int score) {
+    auto best = bestScores.find(username);
+    if (best != bestScores.end()) {
+        if (score <= best->second) return false;
+        root = erase(root, Entry{ username, best->second });
+        best->second = score;
+    }
+    else {
+        bestScores.emplace(username, score);
+    }
+
+    insert(Entry{ username, score });
+    return true;
+}
+
+void Leaderboard::merge(const std::map<std::string, int>& scores) {
+    for (const auto& pair : scores) {
+        submit(pair.first, pair.second);
+    }
+}
+
+int Leaderboard::scoreOf(const std::string& username) const {
+    auto it = bestScores.find(username);
+    return it != bestScores.end() ? it->second : 0;
+}
+
+int Leaderboard::rankOf(const std::string& username) const {
+    auto it = bestScores.find(username);
+    if (it == bestScores.end()) return 0;
+
+    // Players tied on score share a rank, so count only strictly higher scores
+    uint32_t higher = 0;
+    int32_t node = root;
+    while (node != NO_NODE) {
+        if (nodes[node].entry.score > it->second) {
+            higher += sizeOf(nodes[node].left) + 1;
+            node = nodes[node].right;
+        }
+        else {
+            node = nodes[node].left;
+        }
+    }
+    return static_cast<int>(higher) + 1;
+}
+
+std::vector<Leaderboard::Entry> Leaderboard::top(size_t count) const {
+    std::vector<Entry> result;
+    result.reserve(std::min(count, static_cast<size_t>(playerCount())));
+
+    // In-order walk that stops after count entries
+    std::vector<int32_t> path;
+    int32_t node = root;
+    while (result.size() < count && (node != NO_NODE || !path.empty())) {
+        while (node != NO_NODE) {
+            path.push_back(node);
+            node = nodes[node].left;
+        }
+        node = path.back();
+        path.pop_back();
+        result.push_back(nodes[node].entry);
+        node = nodes[node].right;
+    }
+    return result;
+}
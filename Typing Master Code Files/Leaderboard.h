@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Best score per player, kept in rank order so submitting a score, looking
+// up a rank and reading the top K all stay logarithmic in the number of
+// players. One board is shared by all games in the process; it starts from
+// highscores.txt and merges the log again whenever a game shows it.
+class Leaderboard {
+public:
+    struct Entry {
+        std::string username;
+        int score;
+    };
+
+    static Leaderboard& shared();
+
+    explicit Leaderboard(const std::map<std::string, int>& scores);
+
+    // Records a score; returns true if it is the player's new best
+    bool submit(const std::string& username, int score);
+    // Submits every score, e.g. ones other processes appended to the log
+    void merge(const std::map<std::string, int>& scores);
+
+    int scoreOf(const std::string& username) const;
+    int rankOf(const std::string& username) const;  // 1-based, 0 if unranked
+    size_t playerCount() const { return sizeOf(root); }
+    std::vector<Entry> top(size_t count) const;
+
+private:
+    // The ranking is a treap: a search tree ordered by rank (highest score
+    // first, then by name) that random node priorities keep balanced. Each
+    // node knows its subtree size, so a rank is one walk down from the root.
+    // Nodes live in one vector and link to each other by index.
+    static constexpr int32_t NO_NODE = -1;
+
+    struct Node {
+        Entry entry;
+        uint32_t priority;
+        uint32_t size;
+        int32_t left;
+        int32_t right;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int32_t> freeNodes;
+    int32_t root = NO_NODE;
+    uint32_t priorityState = 0x9E3779B9u;
+    std::unordered_map<std::string, int> bestScores;
+
+    uint32_t sizeOf(int32_t node) const { return node == NO_NODE ? 0 : nodes[node].size; }
+    void updateSize(int32_t node);
+    uint32_t nextPriority();
+
+    // Splits off everything ranking above entry into left, the rest into right
+    void split(int32_t node, const Entry& entry, int32_t& left, int32_t& right);
+    int32_t join(int32_t left, int32_t right);
+    void insert(const Entry& entry);
+    int32_t erase(int32_t node, const Entry& entry);
+};
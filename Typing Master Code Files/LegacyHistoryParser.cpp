@@ -0,0 +1,101 @@
+#include "LegacyHistoryParser.h"
+#include <fstream>
+#include <charconv>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+    bool startsWith(std::string_view line, std::string_view prefix) {
+        return line.substr(0, prefix.length()) == prefix;
+    }
+
+    template<typename T>
+    T parseNumber(std::string_view text) {
+        T value = T();
+        std::from_chars(text.data(), text.data() + text.length(), value);
+        return value;
+    }
+}
+
+LegacyHistoryParser::LegacyHistoryParser(const std::string& path) :
+    path(path),
+    buffer(CHUNK_SIZE) {
+    resetRecord();
+}
+
+void LegacyHistoryParser::resetRecord() {
+    usernameLength = 0;
+    dateLength = 0;
+    current = LegacyRecord();
+}
+
+void LegacyHistoryParser::copyValue(std::string_view value, char* dest, size_t& length) {
+    length = std::min(value.length(), FIELD_SIZE);
+    std::memcpy(dest, value.data(), length);
+}
+
+void LegacyHistoryParser::parseLine(std::string_view line,
+    const std::function<void(const LegacyRecord&)>& onRecord) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+
+    if (startsWith(line, "User: ")) {
+        resetRecord();
+        copyValue(line.substr(6), username, usernameLength);
+    }
+    else if (startsWith(line, "Date: ")) copyValue(line.substr(6), date, dateLength);
+    else if (startsWith(line, "WPM: ")) current.wpm = parseNumber<int>(line.substr(5));
+    else if (startsWith(line, "Accuracy: ")) {
+        std::string_view acc = line.substr(10);
+        if (!acc.empty() && acc.back() == '%') acc.remove_suffix(1);
+        current.accuracy = parseNumber<float>(acc);
+    }
+    else if (startsWith(line, "Duration: ")) {
+        std::string_view dur = line.substr(10);
+        current.duration = parseNumber<int>(dur.substr(0, dur.find(' ')));
+    }
+    else if (startsWith(line, "Difficulty: ")) {
+        current.difficulty = parseNumber<int>(line.substr(12));
+    }
+    else if (startsWith(line, "------------------------")) {
+        current.username = std::string_view(username, usernameLength);
+        current.date = std::string_view(date, dateLength);
+        onRecord(current);
+    }
+}
+
+bool LegacyHistoryParser::parse(const std::function<void(const LegacyRecord&)>& onRecord) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    resetRecord();
+    size_t carried = 0;  // Bytes of an unfinished line kept at the front of the buffer
+
+    while (file) {
+        file.read(buffer.data() + carried, buffer.size() - carried);
+        size_t filled = carried + static_cast<size_t>(file.gcount());
+        if (filled == carried) break;
+
+        std::string_view chunk(buffer.data(), filled);
+        size_t lineStart = 0;
+        size_t newline;
+        while ((newline = chunk.find('\n', lineStart)) != std::string_view::npos) {
+            parseLine(chunk.substr(lineStart, newline - lineStart), onRecord);
+            lineStart = newline + 1;
+        }
+
+        carried = filled - lineStart;
+        if (carried == buffer.size()) {
+            // A single line filled the whole buffer; it can't be a field we use
+            carried = 0;
+        }
+        else {
+            std::memmove(buffer.data(), buffer.data() + lineStart, carried);
+        }
+    }
+
+    // Last line without a trailing newline
+    if (carried > 0) {
+        parseLine(std::string_view(buffer.data(), carried), onRecord);
+    }
+    return true;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <functional>
+#include <vector>
+
+// A record from the old typing_history.txt format. The views point into the
+// parser's own storage and are only valid during the callback.
+struct LegacyRecord {
+    std::string_view username;
+    std::string_view date;
+    int wpm;
+    float accuracy;
+    int duration;
+    int difficulty;
+};
+
+// Streams the "User:/Date:/WPM:" text blocks in fixed-size chunks, so files
+// larger than memory can be converted. Fields are parsed in place with
+// from_chars; nothing is allocated per line or per field.
+class LegacyHistoryParser {
+public:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    explicit LegacyHistoryParser(const std::string& path);
+
+    // Returns false if the file could not be opened
+    bool parse(const std::function<void(const LegacyRecord&)>& onRecord);
+
+private:
+    static constexpr size_t FIELD_SIZE = 64;
+
+    std::string path;
+    std::vector<char> buffer;
+
+    char username[FIELD_SIZE];
+    char date[FIELD_SIZE];
+    size_t usernameLength;
+    size_t dateLength;
+    LegacyRecord current;
+
+    void resetRecord();
+    void parseLine(std::string_view line, const std::function<void(const LegacyRecord&)>& onRecord);
+    static void copyValue(std::string_view value, char* dest, size_t& length);
+};
@@ -4,6 +4,11 @@
 #include <sstream>
 #include <iostream>
 #include<vector>
+#include <chrono>
+#include <cmath>
+#include "PasswordHash.h"
+#include "RedrawScheduler.h"
+#include "FrameArena.h"
 
 // Constructor initializes the system
 LoginSystem::LoginSystem() :
@@ -13,29 +18,22 @@ LoginSystem::LoginSystem() :
     passwordActive(false),
     message(""),
     usernameInput(""),
-    passwordInput(""),
-    dataFile("users.txt") {
-    loadUserData();
-}
-
-void LoginSystem::loadUserData() {
-    std::ifstream file(dataFile);
-    if (!file.is_open()) {
-        // If file doesn't exist, create it
-        std::ofstream createFile(dataFile);
-        createFile.close();
-        return;
-    }
-
-    std::string line, username, password;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        if (iss >> username >> password) {
-            userData[username] = password;
-        }
+    passwordInput("") {
+    // users.db is opened lazily per lookup; only accounts imported from
+    // users.txt have work waiting, and it goes to a worker
+    if (userDatabase.hasPlaintext()) {
+        upgradeProgress = std::make_shared<UserDatabase::UpgradeProgress>();
+        pendingUpgrade = std::async(std::launch::async,
+            [database = userDatabase, progress = upgradeProgress]() mutable {
+                return database.upgradePasswords(*progress);
+            });
     }
+}
 
-    file.close();
+LoginSystem::~LoginSystem() {
+    // Quitting only waits for the accounts being hashed; the rest are
+    // picked up on the next start
+    if (upgradeProgress) upgradeProgress->cancelled = true;
 }
 
 void LoginSystem::resetLoginSystem() {
@@ -48,20 +46,6 @@ void LoginSystem::resetLoginSystem() {
     passwordHidden = true;
 }
 
-void LoginSystem::saveUserData() {
-    std::ofstream file(dataFile, std::ios::trunc);
-    if (!file.is_open()) {
-        showMessage("Error saving data!", false);
-        return;
-    }
-
-    for (const auto& pair : userData) {
-        file << pair.first << " " << pair.second << "\n";
-    }
-
-    file.close();
-}
-
 bool LoginSystem::isMouseOver(Rectangle rect) {
     return CheckCollisionPointRec(GetMousePosition(), rect);
 }
@@ -73,12 +57,12 @@ void LoginSystem::drawInputBox(float x, float y, float width, float height,
     DrawRectangleLinesEx(box, 2, isActive ? BLUE : WHITE);
 
     // Display input text
-    std::string displayText = isPassword && passwordHidden ? std::string(input.size(), '*') : input;
-    DrawText(displayText.c_str(), x + 10, y + 10, 20, BLACK);
+    const char* displayText = isPassword && passwordHidden ? FrameArena::instance().repeat('*', input.size()) : input.c_str();
+    DrawText(displayText, x + 10, y + 10, 20, BLACK);
 
     // Draw blinking cursor
     if (isActive && blinkState) {
-        float textWidth = MeasureText(displayText.c_str(), 20);
+        float textWidth = MeasureText(displayText, 20);
         DrawLine(x + 10 + textWidth, y + 10, x + 10 + textWidth, y + 30, BLACK);
     }
 }
@@ -102,32 +86,109 @@ void LoginSystem::showMessage(const std::string& text, bool success) {
 }
 
 void LoginSystem::attemptLogin() {
-    if (validateCredentials(usernameInput, passwordInput)) {
-        showMessage("Login Successful!", true);
-    }
-    else {
-        showMessage("Invalid username or password.", false);
-    }
+    if (isVerifying()) return;
+
+    // Hashing takes a noticeable fraction of a second; keep the frame loop running
+    showMessage("", false);
+    pendingAuth = std::async(std::launch::async,
+        [database = userDatabase, username = usernameInput, password = passwordInput]() mutable {
+            if (checkCredentials(database, username, password)) {
+                return AuthResult{ true, "Login Successful!" };
+            }
+            return AuthResult{ false, "Invalid username or password." };
+        });
 }
 
 void LoginSystem::attemptRegister() {
+    if (isVerifying()) return;
+
     if (usernameInput.empty() || passwordInput.empty()) {
         showMessage("Fields cannot be empty.", false);
     }
-    else if (userData.find(usernameInput) != userData.end()) {
-        showMessage("User already exists.", false);
-    }
     else if (usernameInput.find(' ') != std::string::npos) {
         showMessage("Username cannot contain spaces.", false);
     }
     else {
-        userData[usernameInput] = passwordInput;
-        saveUserData();
-        showMessage("Registration Successful!", true);
+        showMessage("", false);
+        pendingAuth = std::async(std::launch::async,
+            [database = userDatabase, username = usernameInput, password = passwordInput]() mutable {
+                return registerAccount(database, username, password);
+            });
+    }
+}
+
+void LoginSystem::pollPendingAuth() {
+    if (pendingAuth.valid() && pendingAuth.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        AuthResult result = pendingAuth.get();
+        showMessage(result.message, result.success);
+    }
+}
+
+void LoginSystem::pollPendingUpgrade() {
+    if (pendingUpgrade.valid() && pendingUpgrade.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        // A failed upgrade is retried on the next start; accounts it didn't
+        // reach are still hashed as their users log in
+        pendingUpgrade.get();
+    }
+}
+
+void LoginSystem::drawUpgradeProgress(float screenWidth, float y) {
+    if (!pendingUpgrade.valid()) return;
+
+    // Only the count changes, a few times a second at most
+    RedrawScheduler::instance().requestFrameIn(0.25);
+    const char* text = FrameArena::instance().format("Upgrading saved accounts: %u of %u",
+        upgradeProgress->upgraded.load(), upgradeProgress->total.load());
+    DrawText(text, (screenWidth - MeasureText(text, 18)) / 2, y, 18, CLITERAL(Color){150, 150, 150, 255});
+}
+
+bool LoginSystem::checkCredentials(UserDatabase& database, const std::string& username, const std::string& password) {
+    UserDatabase::Account account;
+    if (!database.find(username, account)) {
+        // Take as long as a real check so unknown names can't be told apart
+        verifyPassword(password, std::string(PASSWORD_SALT_SIZE + PASSWORD_KEY_SIZE, '\0'), PASSWORD_HASH_ITERATIONS);
+        return false;
+    }
+
+    // Imported from users.txt and not upgraded yet: check the password as
+    // stored and save its hash now, which costs as long as a real check
+    if (account.scheme == UserDatabase::SCHEME_PLAINTEXT) {
+        UserDatabase::Account upgraded = account;
+        upgraded.scheme = UserDatabase::SCHEME_PBKDF2_SHA256;
+        upgraded.iterations = PASSWORD_HASH_ITERATIONS;
+        upgraded.credential = hashPassword(password, PASSWORD_HASH_ITERATIONS);
+        if (!passwordsEqual(password, account.credential)) return false;
+        database.update(upgraded);
+        return true;
+    }
+
+    return account.scheme == UserDatabase::SCHEME_PBKDF2_SHA256 &&
+        verifyPassword(password, account.credential, account.iterations);
+}
+
+LoginSystem::AuthResult LoginSystem::registerAccount(UserDatabase& database,
+    const std::string& username, const std::string& password) {
+    if (database.exists(username)) {
+        return { false, "User already exists." };
+    }
+
+    UserDatabase::Account account;
+    account.username = username;
+    account.scheme = UserDatabase::SCHEME_PBKDF2_SHA256;
+    account.iterations = PASSWORD_HASH_ITERATIONS;
+    account.credential = hashPassword(password, PASSWORD_HASH_ITERATIONS);
+
+    if (database.add(account)) {
+        return { true, "Registration Successful!" };
     }
+    // Someone else may have taken the name while we were hashing
+    return { false, database.exists(username) ? "User already exists." : "Error saving data!" };
 }
 
 void LoginSystem::handleInput(bool& usernameActive, bool& passwordActive) {
+    // The fields are frozen while they are being checked
+    if (isVerifying()) return;
+
     if (usernameActive || passwordActive) {
         int key = GetCharPressed();
         while (key > 0) {
@@ -153,11 +214,13 @@ void LoginSystem::handleInput(bool& usernameActive, bool& passwordActive) {
     }
 }
 bool LoginSystem::validateCredentials(const std::string& username, const std::string& password) {
-    auto it = userData.find(username);
-    return (it != userData.end() && it->second == password);
+    return checkCredentials(userDatabase, username, password);
 }
 
 void LoginSystem::draw() {
+    pollPendingAuth();
+    pollPendingUpgrade();
+
     float screenWidth = GetScreenWidth();
     float screenHeight = GetScreenHeight();
 
@@ -184,7 +247,8 @@ void LoginSystem::draw() {
     Rectangle registerButton = { loginButtonX, startY + 260, buttonWidth, buttonHeight };
     Rectangle togglePasswordButton = { togglePasswordButtonX, startY + 80, showHideButtonWidth, showHideButtonHeight };
 
-    // Background animation
+    // Background animation; in on-demand mode it only moves when something
+    // else brings a frame
     ClearBackground(BLACK);
 
     // Animated particle effect similar to main menu
@@ -235,13 +299,12 @@ void LoginSystem::draw() {
     DrawText("USERNAME", usernameX, startY - 25 , 20, WHITE);
     DrawText("PASSWORD", passwordX, startY + 55, 20, WHITE);
 
-    // Blinking cursor animation
-    static bool blinkState = true;
-    static float blinkTimer = 0.0f;
-    blinkTimer += GetFrameTime();
-    if (blinkTimer >= 0.5f) {
-        blinkState = !blinkState;
-        blinkTimer = 0.0f;
+    // The cursor blinks on the clock, so an idle field only needs a frame
+    // each time it changes
+    double blinkPhase = GetTime() * 2;
+    bool blinkState = (long long)blinkPhase % 2 == 0;
+    if (usernameActive || passwordActive) {
+        RedrawScheduler::instance().requestFrameIn((std::floor(blinkPhase) + 1 - blinkPhase) / 2);
     }
 
     // Draw modern input boxes
@@ -255,12 +318,12 @@ void LoginSystem::draw() {
             DrawRectangleLinesEx(box, 2, borderColor);
 
             // Text
-            std::string displayText = isPassword && isHidden ? std::string(text.length(), '*') : text;
-            DrawText(displayText.c_str(), box.x + 15, box.y + (box.height - 20) / 2, 20, WHITE);
+            const char* displayText = isPassword && isHidden ? FrameArena::instance().repeat('*', text.length()) : text.c_str();
+            DrawText(displayText, box.x + 15, box.y + (box.height - 20) / 2, 20, WHITE);
 
             // Cursor
             if (isActive && blink) {
-                float textWidth = MeasureText(displayText.c_str(), 20);
+                float textWidth = MeasureText(displayText, 20);
                 DrawRectangle(box.x + 15 + textWidth, box.y + 15, 2, 20, WHITE);
             }
         };
@@ -293,10 +356,21 @@ void LoginSystem::draw() {
     drawModernButton(registerButton, "REGISTER", isMouseOver(registerButton));
     drawModernButton(togglePasswordButton, passwordHidden ? "SHOW" : "HIDE", isMouseOver(togglePasswordButton));
 
-    // Message display with animation
-    if (!message.empty()) {
+    // Pending state while a worker checks the password, otherwise the message
+    if (isVerifying()) {
+        RedrawScheduler::instance().requestFrame();
+        int dots = static_cast<int>(GetTime() * 3) % 4;
+        const char* pendingText = FrameArena::instance().format("Checking credentials%.*s", dots, "...");
+        float pendingPulse = (sin(GetTime() * 4) + 1) / 2;
+        DrawText(pendingText,
+            (screenWidth - MeasureText("Checking credentials...", 20)) / 2,
+            startY + 340, 20,
+            CLITERAL(Color){200, 200, 200, static_cast<unsigned char>(120 + pendingPulse * 135)});
+    }
+    else if (!message.empty()) {
         static float messageAlpha = 0.0f;
         messageAlpha = messageAlpha + (1.0f - messageAlpha) * 0.1f;
+        if (messageAlpha < 0.99f) RedrawScheduler::instance().requestFrame();
         Color messageColor = isMessageSuccess ?
             CLITERAL(Color) { 0, 255, 0, static_cast<unsigned char>(messageAlpha * 255) } :
             CLITERAL(Color) { 255, 0, 0, static_cast<unsigned char>(messageAlpha * 255) };
@@ -307,6 +381,8 @@ void LoginSystem::draw() {
             messageY, 20, messageColor);
     }
 
+    drawUpgradeProgress(screenWidth, startY + 380);
+
     // Footer with subtle animation
     float footerPulse = (sin(GetTime() * 2) + 1) / 2;
     DrawText("Developed by BCSF23M023 & BCSF23M048",
@@ -1,34 +1,53 @@
 #pragma once
 #include <string>
-#include <map>
+#include <future>
+#include <memory>
 #include <raylib.h>
+#include "UserDatabase.h"
 
 class LoginSystem {
 private:
-    std::map<std::string, std::string> userData;
+    // Outcome of a login or registration checked on a worker thread
+    struct AuthResult {
+        bool success;
+        std::string message;
+    };
+
+    UserDatabase userDatabase;
+    std::future<AuthResult> pendingAuth;  // Valid while a check is running
+
+    // Hashing passwords imported in plain text, started with the login
+    // screen; logins and registrations work meanwhile
+    std::shared_ptr<UserDatabase::UpgradeProgress> upgradeProgress;
+    std::future<bool> pendingUpgrade;
     std::string usernameInput;
     std::string passwordInput;
     std::string message;
     bool passwordHidden;
     bool isMessageSuccess;
-    const std::string dataFile = "user.txt";
     bool usernameActive;
     bool passwordActive;
 
     void attemptLogin();
     void attemptRegister();
+    void pollPendingAuth();
+    void pollPendingUpgrade();
+    void drawUpgradeProgress(float screenWidth, float y);
+    static bool checkCredentials(UserDatabase& database, const std::string& username, const std::string& password);
+    static AuthResult registerAccount(UserDatabase& database, const std::string& username, const std::string& password);
 
 public:
     LoginSystem();
-    void loadUserData();
-    void saveUserData();
+    ~LoginSystem();
     void resetLoginSystem();
     bool isMouseOver(Rectangle rect);
     void drawInputBox(float x, float y, float width, float height, std::string& input, bool isPassword, bool isActive, bool blinkState);
     void drawButton(float x, float y, float width, float height, const std::string& text, bool isHovered);
     void showMessage(const std::string& text, bool success);
     void draw(); // Changed from run() to draw()
+    // Blocks for the full hashing cost; draw() runs it off the render thread
     bool validateCredentials(const std::string& username, const std::string& password);
+    bool isVerifying() const { return pendingAuth.valid(); }
     bool getLoginSuccessStatus() const { return isMessageSuccess; }
     std::string getUsernameInput() const { return usernameInput; }
     void handleInput(bool& usernameActive, bool& passwordActive); // New method
@@ -1,4 +1,7 @@
 #include "MainMenu.h"
+#include "FrameStats.h"
+#include "RedrawScheduler.h"
+#include "FrameArena.h"
 
 MainMenu::MainMenu() :
     currentState(MenuState::LOGIN),
@@ -6,10 +9,14 @@ MainMenu::MainMenu() :
     stats(nullptr),
     game(nullptr),
     isLoggedIn(false),
-    shouldClose(false) {
+    shouldClose(false),
+    hasGameSeed(false),
+    gameSeed(0) {
 
+    RedrawScheduler& scheduler = RedrawScheduler::instance();
+    if (scheduler.usesVsync()) SetConfigFlags(FLAG_VSYNC_HINT);
     InitWindow(1280, 800, "Typing Master");
-    SetTargetFPS(60);
+    scheduler.startPacing();
     SetExitKey(0);
 }
 
@@ -18,6 +25,11 @@ MainMenu::~MainMenu() {
     CloseWindow();
 }
 
+void MainMenu::setGameSeed(unsigned int seed) {
+    hasGameSeed = true;
+    gameSeed = seed;
+}
+
 void MainMenu::drawButton(Rectangle rect, const char* text, bool isHovered, float animationProgress) {
     Color bgColor = isHovered ?
         CLITERAL(Color) { 40, 40, 40, 255 } :
@@ -84,6 +96,11 @@ void MainMenu::drawMainMenuButtons() {
     animationProgress = fmin(1.0f, animationProgress + GetFrameTime() * 2);
     titleAngle += GetFrameTime() * 2;
 
+    // Only the buttons growing in need frames of their own. The floating
+    // title, particles and pulses are background motion, which in on-demand
+    // mode moves on when input brings the next frame.
+    if (animationProgress < 1.0f) RedrawScheduler::instance().requestFrame();
+
     // Background with dynamic pattern
     ClearBackground(BLACK);
     drawParticleEffect();
@@ -100,18 +117,18 @@ void MainMenu::drawMainMenuButtons() {
     }
 
     // Welcome message
-    std::string welcomeMsg = "WELCOME, " + username + " !";
+    const char* welcomeMsg = FrameArena::instance().format("WELCOME, %s !", username.c_str());
     int welcomeFontSize = 40;
-    Vector2 welcomeSize = MeasureTextEx(GetFontDefault(), welcomeMsg.c_str(),
+    Vector2 welcomeSize = MeasureTextEx(GetFontDefault(), welcomeMsg,
         welcomeFontSize, 1);
     float welcomeX = 50.0f;
     float welcomeY = 50.0f;
 
     // Welcome message with floating animation
     float offsetY = sin(titleAngle) * 5;
-    DrawText(welcomeMsg.c_str(), welcomeX + 2, welcomeY + offsetY + 2,
+    DrawText(welcomeMsg, welcomeX + 2, welcomeY + offsetY + 2,
         welcomeFontSize, CLITERAL(Color){50, 50, 50, 255});
-    DrawText(welcomeMsg.c_str(), welcomeX, welcomeY + offsetY, welcomeFontSize, WHITE);
+    DrawText(welcomeMsg, welcomeX, welcomeY + offsetY, welcomeFontSize, WHITE);
 
     // Animated decorative lines
     float lineLength = welcomeSize.x + 50.0f * animationProgress;
@@ -251,7 +268,8 @@ void MainMenu::handleMainMenuInput() {
         else if (CheckCollisionPointRec(mousePos, gameBtn)) {
             cleanup();
             game = new FallingWordsGame(username);
-            game->StartGame();
+            if (hasGameSeed) game->StartGame(gameSeed);
+            else game->StartGame();
             currentState = MenuState::GAME;
         }
         else if (CheckCollisionPointRec(mousePos, statsBtn)) {
@@ -290,6 +308,7 @@ void MainMenu::cleanup() {
 
 void MainMenu::run() {
     while (!WindowShouldClose() && !shouldClose) {
+        RedrawScheduler::instance().waitForFrame();
         BeginDrawing();
 
         switch (currentState) {
@@ -342,6 +361,7 @@ void MainMenu::run() {
             break;
         }
 
+        FrameStats::instance().finishFrame();
         EndDrawing();
     }
 }
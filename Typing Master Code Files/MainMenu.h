@@ -24,6 +24,8 @@ private:
     FallingWordsGame* game;
     bool isLoggedIn;
     bool shouldClose;
+    bool hasGameSeed;
+    unsigned int gameSeed;
     Rectangle typingTestBtn;
     Rectangle gameBtn;
     Rectangle statsBtn;
@@ -46,6 +48,8 @@ public:
     MainMenu();
     ~MainMenu();
     void run();
+    // Every falling words game started from the menu plays this seed
+    void setGameSeed(unsigned int seed);
     void setState(MenuState newState);
     MenuState getState() const { return currentState; }
 };
\ No newline at end of file
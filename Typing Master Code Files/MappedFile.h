@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. Kept free of raylib.h so the
+// platform headers it needs on Windows don't clash with raylib's names.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    const char* data() const { return mappedData; }
+    size_t size() const { return mappedSize; }
+    bool isOpen() const { return mappedData != nullptr; }
+
+private:
+    const char* mappedData;
+    size_t mappedSize;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+};
+
+// Exclusive advisory lock held for the lifetime of the object. Every shared
+// data file has its own lock file, so writers to different files never wait
+// on each other.
+class FileLock {
+public:
+    explicit FileLock(const std::string& lockPath);
+    ~FileLock();
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+    bool isLocked() const { return locked; }
+
+private:
+    bool locked;
+#ifdef _WIN32
+    void* fileHandle;
+#else
+    int fileDescriptor;
+#endif
+};
+
+// Moves source over target in one step, replacing target if it exists.
+// Readers holding the old file open keep seeing the old contents.
+bool replaceFile(const std::string& source, const std::string& target);
+
+// Flushes a file's contents through the OS cache to the disk
+bool syncFile(const std::string& path);
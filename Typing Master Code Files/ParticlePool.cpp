@@ -0,0 +1,61 @@
+#include "ParticlePool.h"
+
+namespace {
+    const float GRAVITY = 500.0f;
+}
+
+ParticlePool::ParticlePool() :
+    posX(CAPACITY), posY(CAPACITY),
+    velX(CAPACITY), velY(CAPACITY),
+    radii(CAPACITY),
+    lifetimes(CAPACITY),
+    colors(CAPACITY),
+    count(0) {
+}
+
+bool ParticlePool::spawn(float x, float y, float velocityX, float velocityY, float radius, float lifetime,
+    unsigned int color) {
+    if (count == CAPACITY) return false;
+
+    posX[count] = x;
+    posY[count] = y;
+    velX[count] = velocityX;
+    velY[count] = velocityY;
+    radii[count] = radius;
+    lifetimes[count] = lifetime;
+    colors[count] = color;
+    count++;
+    return true;
+}
+
+void ParticlePool::update(float dt) {
+    // Plain pointers so the compiler knows the arrays don't overlap
+    float* __restrict x = posX.data();
+    float* __restrict y = posY.data();
+    float* __restrict vx = velX.data();
+    float* __restrict vy = velY.data();
+    float* __restrict life = lifetimes.data();
+    for (size_t i = 0; i < count; i++) {
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+        vy[i] += GRAVITY * dt;
+        life[i] -= dt;
+    }
+
+    // Swap-remove: order doesn't matter for particles
+    for (size_t i = 0; i < count;) {
+        if (life[i] > 0.0f) {
+            i++;
+            continue;
+        }
+
+        count--;
+        x[i] = x[count];
+        y[i] = y[count];
+        vx[i] = vx[count];
+        vy[i] = vy[count];
+        radii[i] = radii[count];
+        life[i] = life[count];
+        colors[i] = colors[count];
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// Fixed-capacity particles stored as one array per field. update() moves
+// every particle in one branch-free loop the compiler can vectorize, then
+// drops dead ones by moving the last particle into their slot, so
+// neither spawning nor expiring ever shifts the arrays.
+//
+// Colors are raylib's packed RGBA (ColorToInt/GetColor), which keeps the
+// pool free of raylib so the benchmarks can build it anywhere.
+class ParticlePool {
+public:
+    static constexpr size_t CAPACITY = 65536;
+
+    ParticlePool();
+
+    // False when the pool is full and the particle was dropped
+    bool spawn(float x, float y, float velocityX, float velocityY, float radius, float lifetime, unsigned int color);
+    void update(float dt);
+    void clear() { count = 0; }
+
+    size_t size() const { return count; }
+    float x(size_t i) const { return posX[i]; }
+    float y(size_t i) const { return posY[i]; }
+    float radius(size_t i) const { return radii[i]; }
+    float lifetime(size_t i) const { return lifetimes[i]; }
+    unsigned int color(size_t i) const { return colors[i]; }
+
+private:
+    std::vector<float> posX, posY;
+    std::vector<float> velX, velY;
+    std::vector<float> radii;
+    std::vector<float> lifetimes;
+    std::vector<unsigned int> colors;
+    size_t count;
+};
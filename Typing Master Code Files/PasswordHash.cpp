@@ -0,0 +1,180 @@
+#include "PasswordHash.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+namespace {
+    const uint32_t ROUND_CONSTANTS[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    uint32_t rotateRight(uint32_t value, int bits) {
+        return (value >> bits) | (value << (32 - bits));
+    }
+
+    struct Sha256 {
+        uint32_t state[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+        };
+        uint64_t length = 0;
+        unsigned char buffer[64];
+        size_t buffered = 0;
+
+        void compress(const unsigned char* block) {
+            uint32_t w[64];
+            for (int i = 0; i < 16; i++) {
+                w[i] = (uint32_t(block[i * 4]) << 24) | (uint32_t(block[i * 4 + 1]) << 16) |
+                    (uint32_t(block[i * 4 + 2]) << 8) | uint32_t(block[i * 4 + 3]);
+            }
+            for (int i = 16; i < 64; i++) {
+                uint32_t s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                uint32_t s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+
+            uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+            uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+            for (int i = 0; i < 64; i++) {
+                uint32_t s1 = rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+                uint32_t choose = (e & f) ^ (~e & g);
+                uint32_t temp1 = h + s1 + choose + ROUND_CONSTANTS[i] + w[i];
+                uint32_t s0 = rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+                uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+                uint32_t temp2 = s0 + majority;
+
+                h = g; g = f; f = e; e = d + temp1;
+                d = c; c = b; b = a; a = temp1 + temp2;
+            }
+            state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+            state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        }
+
+        void update(const void* data, size_t size) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            length += size;
+            while (size > 0) {
+                size_t take = std::min(size, sizeof(buffer) - buffered);
+                std::memcpy(buffer + buffered, bytes, take);
+                buffered += take;
+                bytes += take;
+                size -= take;
+                if (buffered == sizeof(buffer)) {
+                    compress(buffer);
+                    buffered = 0;
+                }
+            }
+        }
+
+        void finish(unsigned char digest[32]) {
+            uint64_t bitLength = length * 8;
+            unsigned char padding = 0x80;
+            update(&padding, 1);
+            padding = 0;
+            while (buffered != 56) update(&padding, 1);
+
+            unsigned char lengthBytes[8];
+            for (int i = 0; i < 8; i++) lengthBytes[i] = static_cast<unsigned char>(bitLength >> (56 - i * 8));
+            update(lengthBytes, 8);
+
+            for (int i = 0; i < 8; i++) {
+                digest[i * 4] = static_cast<unsigned char>(state[i] >> 24);
+                digest[i * 4 + 1] = static_cast<unsigned char>(state[i] >> 16);
+                digest[i * 4 + 2] = static_cast<unsigned char>(state[i] >> 8);
+                digest[i * 4 + 3] = static_cast<unsigned char>(state[i]);
+            }
+        }
+    };
+
+    // HMAC with the padded key already absorbed, so each use of it only
+    // hashes the message
+    struct HmacSha256 {
+        Sha256 inner;
+        Sha256 outer;
+
+        explicit HmacSha256(const std::string& key) {
+            unsigned char block[64] = {};
+            if (key.length() > sizeof(block)) {
+                Sha256 keyHash;
+                keyHash.update(key.data(), key.length());
+                keyHash.finish(block);
+            }
+            else {
+                std::memcpy(block, key.data(), key.length());
+            }
+
+            unsigned char pad[64];
+            for (int i = 0; i < 64; i++) pad[i] = block[i] ^ 0x36;
+            inner.update(pad, sizeof(pad));
+            for (int i = 0; i < 64; i++) pad[i] = block[i] ^ 0x5c;
+            outer.update(pad, sizeof(pad));
+        }
+
+        void sign(const void* message, size_t size, unsigned char mac[32]) const {
+            Sha256 innerHash = inner;
+            innerHash.update(message, size);
+            unsigned char innerDigest[32];
+            innerHash.finish(innerDigest);
+
+            Sha256 outerHash = outer;
+            outerHash.update(innerDigest, sizeof(innerDigest));
+            outerHash.finish(mac);
+        }
+    };
+}
+
+std::string pbkdf2Sha256(const std::string& password, const std::string& salt, uint32_t iterations) {
+    HmacSha256 hmac(password);
+
+    // A single output block, so the block index is always 1
+    std::string first = salt;
+    first.append("\0\0\0\1", 4);
+
+    unsigned char block[32];
+    unsigned char key[32];
+    hmac.sign(first.data(), first.length(), block);
+    std::memcpy(key, block, sizeof(key));
+
+    for (uint32_t i = 1; i < iterations; i++) {
+        hmac.sign(block, sizeof(block), block);
+        for (int j = 0; j < 32; j++) key[j] ^= block[j];
+    }
+    return std::string(reinterpret_cast<const char*>(key), sizeof(key));
+}
+
+std::string hashPassword(const std::string& password, uint32_t iterations) {
+    std::random_device random;
+    std::string salt(PASSWORD_SALT_SIZE, '\0');
+    for (char& byte : salt) byte = static_cast<char>(random() & 0xFF);
+    return salt + pbkdf2Sha256(password, salt, iterations);
+}
+
+bool verifyPassword(const std::string& password, const std::string& credential, uint32_t iterations) {
+    if (credential.length() != PASSWORD_SALT_SIZE + PASSWORD_KEY_SIZE || iterations == 0) return false;
+
+    std::string key = pbkdf2Sha256(password, credential.substr(0, PASSWORD_SALT_SIZE), iterations);
+
+    // Compare every byte so the time taken doesn't reveal where they differ
+    unsigned char difference = 0;
+    for (size_t i = 0; i < PASSWORD_KEY_SIZE; i++) {
+        difference |= static_cast<unsigned char>(key[i] ^ credential[PASSWORD_SALT_SIZE + i]);
+    }
+    return difference == 0;
+}
+
+bool passwordsEqual(const std::string& a, const std::string& b) {
+    size_t length = std::max(a.length(), b.length());
+    unsigned char difference = a.length() == b.length() ? 0 : 1;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char left = i < a.length() ? static_cast<unsigned char>(a[i]) : 0;
+        unsigned char right = i < b.length() ? static_cast<unsigned char>(b[i]) : 0;
+        difference |= static_cast<unsigned char>(left ^ right);
+    }
+    return difference == 0;
+}
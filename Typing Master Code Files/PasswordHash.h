@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// PBKDF2-HMAC-SHA256 for stored passwords. The iteration count is the cost
+// knob: each one is two SHA-256 blocks, and it is stored with every account
+// so it can be raised later without invalidating existing passwords.
+constexpr uint32_t PASSWORD_HASH_ITERATIONS = 200000;
+constexpr size_t PASSWORD_SALT_SIZE = 16;
+constexpr size_t PASSWORD_KEY_SIZE = 32;
+
+// Returns a fresh random salt followed by the derived key
+std::string hashPassword(const std::string& password, uint32_t iterations);
+
+// Checks a password against a credential produced by hashPassword
+bool verifyPassword(const std::string& password, const std::string& credential, uint32_t iterations);
+
+// Compares two passwords in a time that depends only on their lengths, for
+// accounts still stored in plain text
+bool passwordsEqual(const std::string& a, const std::string& b);
+
+// Raw PBKDF2-HMAC-SHA256 with a 32-byte output
+std::string pbkdf2Sha256(const std::string& password, const std::string& salt, uint32_t iterations);
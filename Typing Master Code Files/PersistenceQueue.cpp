@@ -0,0 +1,132 @@
+#include "PersistenceQueue.h"
+#include "HighScoreLog.h"
+#include <algorithm>
+
+PersistenceQueue& PersistenceQueue::instance() {
+    static PersistenceQueue queue;
+    return queue;
+}
+
+PersistenceQueue::PersistenceQueue() :
+    stopping(false),
+    hasPendingHighScores(false),
+    queuedBatches(0),
+    committedBatches(0),
+    failedAttempts(0),
+    lastAttemptFailed(false) {
+    worker = std::thread(&PersistenceQueue::run, this);
+}
+
+PersistenceQueue::~PersistenceQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_one();
+    if (worker.joinable()) worker.join();
+}
+
+void PersistenceQueue::saveTypingRecord(const TypingRecord& record) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingRecords.push_back(record);
+        queuedBatches++;
+    }
+    workAvailable.notify_one();
+}
+
+void PersistenceQueue::saveHighScore(const std::string& username, int score) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Only a user's best queued score needs to reach the file
+        auto inserted = pendingHighScores.emplace(username, score);
+        if (!inserted.second && score > inserted.first->second) {
+            inserted.first->second = score;
+        }
+        hasPendingHighScores = true;
+        queuedBatches++;
+    }
+    workAvailable.notify_one();
+}
+
+bool PersistenceQueue::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    unsigned long long target = queuedBatches;
+    unsigned long long failed = failedAttempts;
+    batchCommitted.wait(lock, [this, target, failed] {
+        return committedBatches >= target || failedAttempts != failed;
+        });
+    return committedBatches >= target;
+}
+
+bool PersistenceQueue::saveFailing() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lastAttemptFailed;
+}
+
+void PersistenceQueue::requeue(std::vector<TypingRecord>& records, const std::map<std::string, int>& highScores) {
+    // Ahead of anything queued meanwhile, so results keep their order
+    records.insert(records.end(), pendingRecords.begin(), pendingRecords.end());
+    pendingRecords.swap(records);
+    for (const auto& score : highScores) {
+        auto inserted = pendingHighScores.insert(score);
+        if (!inserted.second) inserted.first->second = std::max(inserted.first->second, score.second);
+    }
+    if (!highScores.empty()) hasPendingHighScores = true;
+}
+
+void PersistenceQueue::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::chrono::milliseconds retryDelay = FIRST_RETRY_DELAY;
+
+    while (true) {
+        workAvailable.wait(lock, [this] {
+            return stopping || !pendingRecords.empty() || hasPendingHighScores;
+            });
+        if (pendingRecords.empty() && !hasPendingHighScores) break;  // Stopping with nothing left
+
+        // Take the whole queue and write it without holding the lock
+        std::vector<TypingRecord> records;
+        records.swap(pendingRecords);
+        std::map<std::string, int> highScores;
+        bool writeScores = hasPendingHighScores;
+        if (writeScores) highScores.swap(pendingHighScores);
+        hasPendingHighScores = false;
+        unsigned long long batch = queuedBatches;
+
+        lock.unlock();
+        bool recordsSaved = true;
+        if (!records.empty()) {
+            HistoryStore store;
+            recordsSaved = store.append(records, true);
+        }
+        bool scoresSaved = true;
+        if (writeScores) {
+            HighScoreLog log;
+            scoresSaved = log.append(highScores, true);
+        }
+        lock.lock();
+
+        if (recordsSaved && scoresSaved) {
+            committedBatches = batch;
+            lastAttemptFailed = false;
+            retryDelay = FIRST_RETRY_DELAY;
+            batchCommitted.notify_all();
+            continue;
+        }
+
+        // Keep whatever didn't reach disk for the next attempt; the part
+        // that did isn't written twice
+        if (recordsSaved) records.clear();
+        if (scoresSaved) highScores.clear();
+        requeue(records, highScores);
+        failedAttempts++;
+        lastAttemptFailed = true;
+        batchCommitted.notify_all();
+
+        // Shutting down gets no more retries; what's left is lost
+        if (stopping) break;
+        workAvailable.wait_for(lock, retryDelay, [this] { return stopping; });
+        retryDelay = std::min(retryDelay * 2, MAX_RETRY_DELAY);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "HistoryStore.h"
+#include <map>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+// Background writer for results and high scores. Saves are queued from the
+// render thread and committed by a worker in batches: everything queued
+// while the previous batch was being written goes out together with one
+// disk sync per file. Each file is locked only while its own batch is
+// written, so other processes sharing the data directory stay consistent.
+// A batch that fails to write stays queued and is retried with a growing
+// delay; nothing counts as committed until it is on disk.
+class PersistenceQueue {
+public:
+    static PersistenceQueue& instance();
+
+    void saveTypingRecord(const TypingRecord& record);
+    void saveHighScore(const std::string& username, int score);
+
+    // Blocks until everything queued so far has been written. Returns
+    // false, without waiting any longer, once a write attempt fails.
+    bool flush();
+
+    // True while the last write attempt failed and its batch is waiting
+    // to be retried
+    bool saveFailing();
+
+    ~PersistenceQueue();
+
+private:
+    PersistenceQueue();
+    PersistenceQueue(const PersistenceQueue&) = delete;
+    PersistenceQueue& operator=(const PersistenceQueue&) = delete;
+
+    static constexpr std::chrono::milliseconds FIRST_RETRY_DELAY{ 500 };
+    static constexpr std::chrono::milliseconds MAX_RETRY_DELAY{ 30000 };
+
+    void run();
+    void requeue(std::vector<TypingRecord>& records, const std::map<std::string, int>& highScores);
+
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable batchCommitted;
+    std::thread worker;
+    bool stopping;
+
+    std::vector<TypingRecord> pendingRecords;
+    std::map<std::string, int> pendingHighScores;
+    bool hasPendingHighScores;
+
+    unsigned long long queuedBatches;     // Bumped on every save request
+    unsigned long long committedBatches;  // Highest request known to be on disk
+    unsigned long long failedAttempts;    // Write attempts that didn't reach disk
+    bool lastAttemptFailed;
+};
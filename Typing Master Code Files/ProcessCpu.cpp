@@ -0,0 +1,29 @@
+#include "ProcessCpu.h"
+
+// Kept apart from raylib.h, whose names clash with windows.h
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+double processCpuSeconds() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0.0;
+
+    auto seconds = [](const FILETIME& time) {
+        ULARGE_INTEGER ticks;
+        ticks.LowPart = time.dwLowDateTime;
+        ticks.HighPart = time.dwHighDateTime;
+        return ticks.QuadPart / 1e7;  // 100 ns ticks
+    };
+    return seconds(kernel) + seconds(user);
+#else
+    timespec time;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0) return 0.0;
+    return time.tv_sec + time.tv_nsec / 1e9;
+#endif
+}
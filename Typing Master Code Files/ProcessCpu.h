@@ -0,0 +1,4 @@
+#pragma once
+
+// CPU time used by every thread of this process so far, in seconds
+double processCpuSeconds();
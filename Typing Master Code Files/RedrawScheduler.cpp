@@ -0,0 +1,119 @@
+#include "RedrawScheduler.h"
+#include "raylib.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace {
+    // How often input is checked while waiting for a frame
+    const double POLL_INTERVAL = 1.0 / 60.0;
+    const double LOW_LATENCY_POLL_INTERVAL = 0.001;
+    const int DEFAULT_FPS = 60;
+}
+
+RedrawScheduler& RedrawScheduler::instance() {
+    static RedrawScheduler scheduler;
+    return scheduler;
+}
+
+void RedrawScheduler::setLowLatency(bool enabled) {
+    lowLatency = enabled;
+    if (pacingStarted) applyPacing();
+}
+
+void RedrawScheduler::setTargetFps(int fps) {
+    requestedFps = fps;
+    if (pacingStarted) applyPacing();
+}
+
+void RedrawScheduler::startPacing() {
+    pacingStarted = true;
+    applyPacing();
+}
+
+void RedrawScheduler::applyPacing() {
+    targetFps = requestedFps;
+    if (targetFps < 0) {
+        // High-refresh monitors get their full rate in low-latency mode
+        targetFps = lowLatency ? std::max(DEFAULT_FPS, GetMonitorRefreshRate(GetCurrentMonitor())) : DEFAULT_FPS;
+    }
+
+    // In low-latency mode waitForFrame() does the pacing, so raylib must not
+    // sleep before it polls
+    SetTargetFPS(lowLatency ? 0 : targetFps);
+}
+
+void RedrawScheduler::requestFrameIn(double seconds) {
+    double at = GetTime() + seconds;
+    if (nextFrameAt < 0.0 || at < nextFrameAt) nextFrameAt = at;
+}
+
+void RedrawScheduler::pollInput() {
+    PollInputEvents();
+    previousPollAt = lastPollAt;
+    lastPollAt = GetTime();
+}
+
+bool RedrawScheduler::keyOrButtonArrived() const {
+    for (int button = MOUSE_BUTTON_LEFT; button <= MOUSE_BUTTON_MIDDLE; button++) {
+        if (IsMouseButtonPressed(button) || IsMouseButtonReleased(button)) return true;
+    }
+
+    // Every key, not the key queue: reading GetKeyPressed here would take
+    // the key away from the screen that handles it
+    for (int key = KEY_SPACE; key <= KEY_KB_MENU; key++) {
+        if (IsKeyPressed(key) || IsKeyPressedRepeat(key) || IsKeyReleased(key)) return true;
+    }
+    return false;
+}
+
+bool RedrawScheduler::inputArrived() const {
+    if (IsWindowResized() || GetMouseWheelMove() != 0.0f) return true;
+
+    Vector2 mouseDelta = GetMouseDelta();
+    if (mouseDelta.x != 0.0f || mouseDelta.y != 0.0f) return true;
+
+    return keyOrButtonArrived();
+}
+
+void RedrawScheduler::waitForFrame() {
+    // EndDrawing polled input just before this
+    previousPollAt = lastPollAt;
+    lastPollAt = GetTime();
+
+    // Requests made while drawing the last frame are for this wait
+    double requestedAt = nextFrameAt;
+    nextFrameAt = -1.0;
+
+    // The earliest a paced frame may start, and when this one is due;
+    // negative if only input can start it
+    double now = lastPollAt;
+    double tickAt = (lowLatency && targetFps > 0) ? frameStartedAt + 1.0 / targetFps : now;
+    double dueAt = tickAt;
+    if (onDemand) dueAt = requestedAt >= 0.0 ? std::max(requestedAt, tickAt) : -1.0;
+
+    frameInputAt = -1.0;
+    while (!WindowShouldClose()) {
+        // A key or click starts a frame at once; mouse motion waits for the tick
+        if (keyOrButtonArrived() || (now >= tickAt && inputArrived())) {
+            frameInputAt = previousPollAt;
+            break;
+        }
+        if (dueAt >= 0.0 && now >= dueAt) break;
+
+        if (dueAt < 0.0 && now >= tickAt) {
+            // Nothing is due, so sleep in the event loop until the OS has an event
+            EnableEventWaiting();
+            pollInput();
+            DisableEventWaiting();
+        }
+        else {
+            double interval = lowLatency ? LOW_LATENCY_POLL_INTERVAL : POLL_INTERVAL;
+            double wakeAt = dueAt >= 0.0 ? dueAt : tickAt;
+            std::this_thread::sleep_for(std::chrono::duration<double>(std::min(wakeAt - now, interval)));
+            pollInput();
+        }
+        now = lastPollAt;
+    }
+    frameStartedAt = GetTime();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// Decides when the next frame is drawn. Every frame loop calls
+// waitForFrame() before BeginDrawing.
+//
+// Normally raylib paces frames at the target rate. In on-demand mode the
+// loop sleeps until there is input or a screen asked to be redrawn.
+// Screens report motion while they draw: an animation asks for the next
+// frame, a blinking cursor asks for one when it next changes. A screen
+// that reports nothing is drawn again only when the user does something.
+//
+// In low-latency mode the scheduler paces frames itself, at the monitor's
+// refresh rate unless told otherwise. It polls input in short slices while
+// it waits, and a key or click starts a frame at once instead of waiting
+// for the next tick. Input is then handled and drawn within about a
+// millisecond of its arrival, rather than up to a frame later.
+class RedrawScheduler {
+public:
+    static RedrawScheduler& instance();
+
+    void setOnDemand(bool enabled) { onDemand = enabled; }
+    bool isOnDemand() const { return onDemand; }
+    void setLowLatency(bool enabled);
+    bool isLowLatency() const { return lowLatency; }
+    // 0 means uncapped; negative picks the default for the mode
+    void setTargetFps(int fps);
+    void setVsync(bool enabled) { vsync = enabled; }
+    bool usesVsync() const { return vsync; }
+
+    // Call once InitWindow has run
+    void startPacing();
+
+    // Something on screen is moving; draw the next frame right away
+    void requestFrame() { requestFrameIn(0.0); }
+    // Something on screen changes by itself after this many seconds
+    void requestFrameIn(double seconds);
+
+    // Returns once the next frame should be drawn
+    void waitForFrame();
+
+    // If this frame handles new input, the time of the input poll before
+    // the one that delivered it. The input arrived after this, so the time
+    // from here to the end of drawing bounds its latency. Negative otherwise.
+    double frameInputAfter() const { return frameInputAt; }
+
+private:
+    RedrawScheduler() = default;
+
+    void applyPacing();
+    void pollInput();
+    bool keyOrButtonArrived() const;
+    bool inputArrived() const;
+
+    bool onDemand = false;
+    bool lowLatency = false;
+    bool vsync = false;
+    bool pacingStarted = false;
+    int requestedFps = -1;
+    int targetFps = 60;
+    double nextFrameAt = 0.0;      // GetTime() of the earliest request; negative if none.
+                                   // The first frame is due at once, before any input.
+    double frameStartedAt = 0.0;
+    double lastPollAt = -1.0;
+    double previousPollAt = -1.0;
+    double frameInputAt = -1.0;
+};
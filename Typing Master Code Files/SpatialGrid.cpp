@@ -0,0 +1,32 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+
+SpatialGrid::SpatialGrid(int capacity) :
+    cellHead(COLS * ROWS, -1),
+    entryNext(capacity),
+    entryId(capacity),
+    entryCount(0) {
+}
+
+void SpatialGrid::clear() {
+    std::fill(cellHead.begin(), cellHead.end(), -1);
+    entryCount = 0;
+}
+
+void SpatialGrid::insert(int id, float x, float y) {
+    if (entryCount == (int)entryId.size()) return;
+
+    int cell = row(y) * COLS + column(x);
+    entryId[entryCount] = id;
+    entryNext[entryCount] = cellHead[cell];
+    cellHead[cell] = entryCount;
+    entryCount++;
+}
+
+int SpatialGrid::column(float x) const {
+    return std::clamp((int)(x / CELL_SIZE), 0, COLS - 1);
+}
+
+int SpatialGrid::row(float y) const {
+    return std::clamp((int)(y / CELL_SIZE), 0, ROWS - 1);
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <vector>
+
+// Uniform grid of square cells over screen space. Points outside the grid
+// are kept in its edge cells, so lookups stay correct, only slower there.
+// Entries are ids the caller resolves; the grid is meant to be cleared
+// and refilled whenever the points move.
+class SpatialGrid {
+public:
+    static constexpr float CELL_SIZE = 150.0f;
+    static constexpr int COLS = 32;
+    static constexpr int ROWS = 16;
+
+    // Room for this many entries between clears
+    explicit SpatialGrid(int capacity);
+
+    void clear();
+    void insert(int id, float x, float y);
+
+    int column(float x) const;
+    int row(float y) const;
+
+    template <typename Visit>
+    void forEachInCell(int col, int row, Visit visit) const {
+        for (int entry = cellHead[row * COLS + col]; entry >= 0; entry = entryNext[entry]) {
+            visit(entryId[entry]);
+        }
+    }
+
+    // Every id in the cells that overlap the square around (x, y)
+    template <typename Visit>
+    void forEachNear(float x, float y, float radius, Visit visit) const {
+        int lastRow = row(y + radius);
+        int lastCol = column(x + radius);
+        for (int r = row(y - radius); r <= lastRow; r++) {
+            for (int c = column(x - radius); c <= lastCol; c++) {
+                forEachInCell(c, r, visit);
+            }
+        }
+    }
+
+private:
+    std::vector<int> cellHead;
+    std::vector<int> entryNext;
+    std::vector<int> entryId;
+    int entryCount;
+};
@@ -1,8 +1,13 @@
 #include "Stats.h"
+#include "PersistenceQueue.h"
+#include "FrameArena.h"
+#include "RedrawScheduler.h"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <iomanip> 
+#include <chrono>
+#include <cmath>
 
 template<typename T>
 T clamp(T value, T min, T max) {
@@ -14,6 +19,7 @@ T clamp(T value, T min, T max) {
 
 Stats::Stats(const std::string& username) :
     username(username),
+    unsavedResults(false),
     scrollOffset(0),
     maxScroll(0),
     avgWPM(0),
@@ -34,65 +40,60 @@ Stats::Stats(const std::string& username) :
     buttonHoverColor = { 0, 140, 240, 255 };
 
     loadStats();
-    calculateAverages();
 }
 
 void Stats::loadStats() {
-    std::ifstream file("typing_history.txt");
-    if (!file.is_open()) return;
+    if (pendingLoad.valid()) return;
 
-    TypingRecord currentRecord;
-    std::string line;
+    // Waiting for queued results and reading the history both touch the
+    // disk; the screen shows a loading state meanwhile
+    pendingLoad = std::async(std::launch::async, readStats, username);
+}
 
-    while (std::getline(file, line)) {
-        if (line.find("User: ") == 0) {
-            currentRecord = TypingRecord();
-            currentRecord.username = line.substr(6);
-        }
-        else if (line.find("Date: ") == 0) currentRecord.date = line.substr(6);
-        else if (line.find("WPM: ") == 0) currentRecord.wpm = std::stoi(line.substr(5));
-        else if (line.find("Accuracy: ") == 0) {
-            std::string acc = line.substr(10);
-            acc = acc.substr(0, acc.length() - 1); // Remove %
-            currentRecord.accuracy = std::stof(acc);
-        }
-        else if (line.find("Duration: ") == 0) {
-            std::string dur = line.substr(10);
-            currentRecord.duration = std::stoi(dur.substr(0, dur.find(" ")));
-        }
-        else if (line.find("Difficulty: ") == 0) {
-            currentRecord.difficulty = std::stoi(line.substr(12));
-        }
-        else if (line.find("------------------------") == 0) {
-            if (currentRecord.username == username) {
-                userRecords.push_back(currentRecord);
-            }
-        }
-    }
+Stats::LoadedStats Stats::readStats(const std::string& username) {
+    // Pick up a result that may still be on its way to disk
+    LoadedStats loaded;
+    loaded.unsaved = !PersistenceQueue::instance().flush();
+
+    HistoryStore store;
+    loaded.records = store.loadUser(username);
 
     // Sort records by date (newest first)
-    std::sort(userRecords.begin(), userRecords.end(),
+    std::sort(loaded.records.begin(), loaded.records.end(),
         [](const TypingRecord& a, const TypingRecord& b) {
             return a.date > b.date;
         });
-}
 
-void Stats::calculateAverages() {
-    if (userRecords.empty()) return;
+    loaded.archivedSummaries = store.loadArchivedSummaries(username);
 
-    float totalWPM = 0;
-    float totalAccuracy = 0;
-    bestWPM = 0;
+    // Totals are kept up to date by the history index on every save
+    loaded.summary = store.loadSummary(username);
+    return loaded;
+}
 
-    for (const auto& record : userRecords) {
-        totalWPM += record.wpm;
-        totalAccuracy += record.accuracy;
-        bestWPM = std::max(bestWPM, record.wpm);
+void Stats::pollPendingLoad() {
+    if (pendingLoad.valid() && pendingLoad.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        LoadedStats loaded = pendingLoad.get();
+        userRecords = std::move(loaded.records);
+        archivedSummaries = std::move(loaded.archivedSummaries);
+        unsavedResults = loaded.unsaved;
+        totalTests = loaded.summary.totalTests;
+        avgWPM = loaded.summary.avgWPM;
+        avgAccuracy = loaded.summary.avgAccuracy;
+        bestWPM = loaded.summary.bestWPM;
     }
+}
 
-    totalTests = userRecords.size();
-    avgWPM = totalWPM / totalTests;
-    avgAccuracy = totalAccuracy / totalTests;
+void Stats::drawLoading() {
+    // Same pending style as the login screen's credential check
+    int dots = static_cast<int>(GetTime() * 3) % 4;
+    const char* loadingText = FrameArena::instance().format("Loading statistics%.*s", dots, "...");
+    float pulse = (sin(GetTime() * 4) + 1) / 2;
+    DrawText(loadingText,
+        (GetScreenWidth() - MeasureText("Loading statistics...", 20)) / 2,
+        GetScreenHeight() / 2, 20,
+        Color{ 200, 200, 200, static_cast<unsigned char>(120 + pulse * 135) });
+    RedrawScheduler::instance().requestFrame();
 }
 
 void Stats::drawBackButton() {
@@ -124,37 +125,45 @@ void Stats::drawHeader() {
     Rectangle headerBg = { 0, 0, (float)GetScreenWidth(), 150 };
     DrawRectangleRec(headerBg, cardColor);
 
-    std::string title = "Typing Statistics for " + username;
-    DrawText(title.c_str(),
-        centerX - MeasureText(title.c_str(), 40) / 2,
+    FrameArena& arena = FrameArena::instance();
+    const char* title = arena.format("Typing Statistics for %s", username.c_str());
+    DrawText(title,
+        centerX - MeasureText(title, 40) / 2,
         20, 40, textColor);
 
     float startX = centerX - 400;
     float startY = 80;
     float width = 200;
 
-    std::vector<std::pair<std::string, std::string>> stats = {
-        {"Total Tests", std::to_string(totalTests)},
-        {"Avg WPM", std::to_string((int)avgWPM)},
-        {"Best WPM", std::to_string(bestWPM)},
-        {"Avg Accuracy", std::to_string((int)avgAccuracy) + "%"}
+    bool loading = pendingLoad.valid();
+    const char* stats[][2] = {
+        {"Total Tests", loading ? "-" : arena.format("%d", totalTests)},
+        {"Avg WPM", loading ? "-" : arena.format("%d", (int)avgWPM)},
+        {"Best WPM", loading ? "-" : arena.format("%d", bestWPM)},
+        {"Avg Accuracy", loading ? "-" : arena.format("%d%%", (int)avgAccuracy)}
     };
 
-    for (size_t i = 0; i < stats.size(); i++) {
+    for (size_t i = 0; i < 4; i++) {
         Rectangle statBg = { startX + (i * width), startY, width - 10, 50 };
         DrawRectangleRec(statBg, highlightColor);
         DrawRectangleLinesEx(statBg, 1, accentColor);
 
-        DrawText(stats[i].first.c_str(),
+        DrawText(stats[i][0],
             statBg.x + 10,
             statBg.y + 5,
             20, textColor);
 
-        DrawText(stats[i].second.c_str(),
+        DrawText(stats[i][1],
             statBg.x + 10,
             statBg.y + 25,
             25, accentColor);
     }
+
+    // The queue keeps retrying; until then the newest results are missing here
+    if (!loading && unsavedResults) {
+        const char* warning = "Some results couldn't be saved yet and will be retried";
+        DrawText(warning, centerX - MeasureText(warning, 16) / 2, startY + 54, 16, RED);
+    }
 }
 
 void Stats::drawStatsCard(const TypingRecord& record, float x, float y, bool isHovered) {
@@ -166,22 +175,52 @@ void Stats::drawStatsCard(const TypingRecord& record, float x, float y, bool isH
     float textY = y + 20;
     float spacing = 30;
 
+    FrameArena& arena = FrameArena::instance();
     DrawText(record.date.c_str(), textX, textY, 20, textColor);
 
     textY += spacing;
-    DrawText(("WPM: " + std::to_string(record.wpm)).c_str(),
+    DrawText(arena.format("WPM: %d", record.wpm),
         textX, textY, 25, accentColor);
 
     textY += spacing;
-    DrawText(("Accuracy: " + std::to_string((int)record.accuracy) + "%").c_str(),
+    DrawText(arena.format("Accuracy: %d%%", (int)record.accuracy),
+        textX, textY, 20, textColor);
+
+    textY += spacing;
+    DrawText(arena.format("Duration: %ds", record.duration),
+        textX, textY, 20, textColor);
+
+    textY += spacing;
+    DrawText(arena.format("Difficulty: %d", record.difficulty),
         textX, textY, 20, textColor);
+}
+
+void Stats::drawArchiveCard(const HistoryStore::SegmentSummary& summary, float x, float y, bool isHovered) {
+    Rectangle cardBg = { x, y, CARD_WIDTH, CARD_HEIGHT };
+    DrawRectangleRec(cardBg, isHovered ? highlightColor : cardColor);
+    DrawRectangleLinesEx(cardBg, 1, accentColor);
+
+    float textX = x + 20;
+    float textY = y + 20;
+    float spacing = 30;
+
+    // Dates are shown without their time of day
+    FrameArena& arena = FrameArena::instance();
+    DrawText(arena.format("From %.10s", summary.firstDate.c_str()), textX, textY, 20, textColor);
+
+    textY += spacing;
+    DrawText(arena.format("To %.10s", summary.lastDate.c_str()), textX, textY, 20, textColor);
 
     textY += spacing;
-    DrawText(("Duration: " + std::to_string(record.duration) + "s").c_str(),
+    DrawText(arena.format("Avg WPM: %d", (int)summary.stats.avgWPM),
+        textX, textY, 25, accentColor);
+
+    textY += spacing;
+    DrawText(arena.format("Best WPM: %d", summary.stats.bestWPM),
         textX, textY, 20, textColor);
 
     textY += spacing;
-    DrawText(("Difficulty: " + std::to_string(record.difficulty)).c_str(),
+    DrawText(arena.format("Tests: %d  Accuracy: %d%%", summary.stats.totalTests, (int)summary.stats.avgAccuracy),
         textX, textY, 20, textColor);
 }
 
@@ -192,7 +231,9 @@ void Stats::drawStatsTable() {
     float screenWidth = (float)GetScreenWidth();
 
     // Calculate grid layout
-    int totalRows = (int)ceil(userRecords.size() / (float)CARDS_PER_ROW);
+    // Individual results first, then one summary card per archived segment
+    size_t totalCards = userRecords.size() + archivedSummaries.size();
+    int totalRows = (int)ceil(totalCards / (float)CARDS_PER_ROW);
     float totalContentHeight = totalRows * (CARD_HEIGHT + CARD_SPACING);
 
     // Adjust maxScroll calculation to prevent overscrolling
@@ -217,8 +258,8 @@ void Stats::drawStatsTable() {
         }
 
         for (int col = 0; col < CARDS_PER_ROW; col++) {
-            int index = row * CARDS_PER_ROW + col;
-            if (index >= userRecords.size()) break;
+            size_t index = (size_t)(row * CARDS_PER_ROW + col);
+            if (index >= totalCards) break;
 
             float x = (screenWidth - (CARD_WIDTH * CARDS_PER_ROW + CARD_SPACING * (CARDS_PER_ROW - 1))) / 2
                 + col * (CARD_WIDTH + CARD_SPACING);
@@ -229,7 +270,12 @@ void Stats::drawStatsTable() {
 
             // Apply scissor test to clip cards at header
             BeginScissorMode(0, HEADER_HEIGHT, GetScreenWidth(), GetScreenHeight() - HEADER_HEIGHT);
-            drawStatsCard(userRecords[index], x, y, isHovered);
+            if (index < userRecords.size()) {
+                drawStatsCard(userRecords[index], x, y, isHovered);
+            }
+            else {
+                drawArchiveCard(archivedSummaries[index - userRecords.size()], x, y, isHovered);
+            }
             EndScissorMode();
         }
     }
@@ -337,8 +383,11 @@ bool Stats::handleInput() {
 }
 
 void Stats::draw() {
+    pollPendingLoad();
+
     ClearBackground(backgroundColor);
     drawHeader();
     drawBackButton();
-    drawStatsTable();
+    if (pendingLoad.valid()) drawLoading();
+    else drawStatsTable();
 }
\ No newline at end of file
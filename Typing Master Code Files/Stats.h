@@ -3,16 +3,9 @@
 
 #include <string>
 #include <vector>
+#include <future>
 #include <raylib.h>
-
-struct TypingRecord {
-    std::string username;
-    std::string date;
-    int wpm;
-    float accuracy;
-    int duration;
-    int difficulty;
-};
+#include "HistoryStore.h"
 
 class Stats {
 public:
@@ -25,15 +18,29 @@ private:
     void drawHeader();
     void drawStatsTable();
     void drawStatsCard(const TypingRecord& record, float x, float y, bool isHovered);
+    void drawArchiveCard(const HistoryStore::SegmentSummary& summary, float x, float y, bool isHovered);
     void drawAverageStats();
-    void calculateAverages();
+    void drawLoading();
+    void pollPendingLoad();
     bool showMainMenu;
     Color buttonColor;
     Color buttonHoverColor;
     void drawBackButton();
 
+    // Everything the screen shows, read from disk on a worker thread
+    struct LoadedStats {
+        std::vector<TypingRecord> records;
+        std::vector<HistoryStore::SegmentSummary> archivedSummaries;
+        HistoryStore::UserSummary summary;
+        bool unsaved;  // Some queued results couldn't be written yet
+    };
+    std::future<LoadedStats> pendingLoad;  // Valid while the history is being read
+    static LoadedStats readStats(const std::string& username);
+
     std::string username;
     std::vector<TypingRecord> userRecords;
+    std::vector<HistoryStore::SegmentSummary> archivedSummaries;  // Older history, one card per segment
+    bool unsavedResults;
     float scrollOffset;
     float maxScroll;
 
@@ -0,0 +1,37 @@
+#include "TextLayout.h"
+#include "FrameArena.h"
+#include <map>
+#include <tuple>
+
+GlyphMetrics::GlyphMetrics(Font font, float fontSize, float spacing) :
+    letterSpacing(spacing) {
+    char glyph[2] = { 0, 0 };
+    for (int c = 0; c < 128; c++) {
+        glyph[0] = static_cast<char>(c);
+        advances[c] = (c < 32) ? 0.0f : MeasureTextEx(font, glyph, fontSize, spacing).x;
+    }
+}
+
+const GlyphMetrics& GlyphMetrics::forFont(Font font, float fontSize, float spacing) {
+    static std::map<std::tuple<unsigned int, float, float>, GlyphMetrics> cache;
+
+    auto key = std::make_tuple(font.texture.id, fontSize, spacing);
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        it = cache.emplace(key, GlyphMetrics(font, fontSize, spacing)).first;
+    }
+    return it->second;
+}
+
+const GlyphMetrics& GlyphMetrics::forDefaultFont(int fontSize) {
+    // MeasureText and DrawText clamp to the default font's size of 10 and
+    // space letters by size / 10
+    const int defaultFontSize = 10;
+    if (fontSize < defaultFontSize) fontSize = defaultFontSize;
+    return forFont(GetFontDefault(), (float)fontSize, (float)(fontSize / defaultFontSize));
+}
+
+void drawTextRun(std::string_view text, float x, float y, int fontSize, Color color) {
+    // DrawText needs a terminated string
+    DrawText(FrameArena::instance().copy(text), (int)x, (int)y, fontSize, color);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <string_view>
+#include "raylib.h"
+#include "TextWrap.h"
+
+// Draws text with DrawText without building a new string for it
+void drawTextRun(std::string_view text, float x, float y, int fontSize, Color color);
+
+inline bool sameColor(Color a, Color b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+// Draws text[begin, end) starting at (x, y) as runs of same-coloured
+// characters, one DrawText per run, and returns how many draws it took.
+// Runs line up with per-character drawing because DrawText spaces glyphs
+// by the same advances and spacing the metrics hold.
+template <typename ColorAt>
+int drawColoredRuns(std::string_view text, size_t begin, size_t end, float x, float y, int fontSize,
+    const GlyphMetrics& metrics, ColorAt colorAt) {
+    int draws = 0;
+    size_t runStart = begin;
+    while (runStart < end) {
+        Color color = colorAt(runStart);
+        float runAdvance = metrics.advance(text[runStart]) + metrics.spacing();
+        size_t runEnd = runStart + 1;
+        while (runEnd < end && sameColor(colorAt(runEnd), color)) {
+            runAdvance += metrics.advance(text[runEnd]) + metrics.spacing();
+            runEnd++;
+        }
+
+        drawTextRun(text.substr(runStart, runEnd - runStart), x, y, fontSize, color);
+        draws++;
+        x += runAdvance;
+        runStart = runEnd;
+    }
+    return draws;
+}
@@ -0,0 +1,100 @@
+#include "TextWrap.h"
+#include <algorithm>
+
+namespace {
+    // Appends the lines of text[from..], with a line starting at `from`.
+    // Starting at any existing line's start gives the same lines as
+    // wrapping the whole text, which is what lets WrappedText rewrap a tail.
+    // sums is scratch space the caller owns.
+    void wrapFrom(std::string_view text, size_t from, float maxWidth, const GlyphMetrics& metrics,
+        std::vector<TextLine>& lines, std::vector<float>& sums) {
+        // sums[i] is the advance of text[from, from + i), so any span's width
+        // is two lookups
+        sums.resize(text.length() - from + 1);
+        sums[0] = 0.0f;
+        for (size_t i = from; i < text.length(); i++) {
+            sums[i - from + 1] = sums[i - from] + metrics.advance(text[i]);
+        }
+        auto spanWidth = [&](size_t begin, size_t end) {
+            return end > begin ? sums[end - from] - sums[begin - from] + metrics.spacing() * (end - begin - 1) : 0.0f;
+        };
+
+        // The current line is [lineStart, wordStart) and the word being read
+        // starts at wordStart, with its leading separator
+        size_t lineStart = from;
+        size_t wordStart = from;
+        for (size_t i = from; i < text.length(); i++) {
+            if (text[i] != ' ' && text[i] != '\n') continue;
+
+            if (spanWidth(lineStart, i) > maxWidth) {
+                if (wordStart > lineStart) lines.push_back({ lineStart, wordStart - lineStart });
+                lineStart = wordStart;
+            }
+            wordStart = i;
+        }
+
+        if (wordStart < text.length() && spanWidth(lineStart, text.length()) > maxWidth) {
+            if (wordStart > lineStart) lines.push_back({ lineStart, wordStart - lineStart });
+            lineStart = wordStart;
+        }
+        if (lineStart < text.length()) {
+            lines.push_back({ lineStart, text.length() - lineStart });
+        }
+    }
+}
+
+GlyphMetrics::GlyphMetrics(const float (&glyphAdvances)[128], float spacing) :
+    letterSpacing(spacing) {
+    std::copy(glyphAdvances, glyphAdvances + 128, advances);
+}
+
+float GlyphMetrics::width(std::string_view text) const {
+    // MeasureText starts over at each line break and keeps the widest line
+    float widest = 0.0f;
+    size_t lineStart = 0;
+    while (lineStart <= text.length()) {
+        size_t lineEnd = std::min(text.find('\n', lineStart), text.length());
+        if (lineEnd > lineStart) {
+            float total = 0.0f;
+            for (size_t i = lineStart; i < lineEnd; i++) total += advance(text[i]);
+            widest = std::max(widest, total + letterSpacing * (lineEnd - lineStart - 1));
+        }
+        lineStart = lineEnd + 1;
+    }
+    return widest;
+}
+
+std::vector<TextLine> wrapLines(std::string_view text, float maxWidth, const GlyphMetrics& metrics) {
+    std::vector<TextLine> lines;
+    std::vector<float> sums;
+    wrapFrom(text, 0, maxWidth, metrics, lines, sums);
+    return lines;
+}
+
+void WrappedText::assign(std::string_view text, float maxWidth, const GlyphMetrics& textMetrics) {
+    width = maxWidth;
+    metrics = &textMetrics;
+    wrapped.clear();
+    wrapFrom(text, 0, width, *metrics, wrapped, advanceSums);
+}
+
+void WrappedText::update(std::string_view text, size_t firstChanged) {
+    if (metrics == nullptr) return;
+
+    // An edit can pull the start of its line back onto the line before
+    size_t line = lineOf(firstChanged);
+    if (line > 0) line--;
+
+    size_t from = line < wrapped.size() ? wrapped[line].start : 0;
+    wrapped.resize(std::min(line, wrapped.size()));
+    wrapFrom(text, std::min(from, text.length()), width, *metrics, wrapped, advanceSums);
+}
+
+size_t WrappedText::lineOf(size_t index) const {
+    if (wrapped.empty()) return 0;
+
+    auto it = std::lower_bound(wrapped.begin(), wrapped.end(), index,
+        [](const TextLine& line, size_t value) { return line.start + line.length < value; });
+    if (it == wrapped.end()) return wrapped.size() - 1;
+    return it - wrapped.begin();
+}
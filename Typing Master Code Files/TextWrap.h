@@ -0,0 +1,157 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+// Text measuring and word wrapping, without raylib so it builds on its
+// own. Measuring a Font and the font lookups live in TextLayout.cpp, and
+// TextLayout.h adds the drawing helpers.
+struct Font;
+
+// Advances of the ASCII glyphs of one font at one size, measured once so
+// text widths become sums instead of MeasureText calls
+class GlyphMetrics {
+public:
+    GlyphMetrics(Font font, float fontSize, float spacing);
+    // From advances already measured; character codes below 32 should be 0
+    GlyphMetrics(const float (&glyphAdvances)[128], float spacing);
+
+    // Cached per font, size and spacing; the first call measures the glyphs
+    static const GlyphMetrics& forFont(Font font, float fontSize, float spacing);
+    // The font, size and spacing DrawText and MeasureText use
+    static const GlyphMetrics& forDefaultFont(int fontSize);
+
+    float advance(char c) const {
+        unsigned char index = static_cast<unsigned char>(c);
+        return index < 128 ? advances[index] : advances['?'];
+    }
+    float spacing() const { return letterSpacing; }
+
+    // Same width MeasureTextEx reports; for text with line breaks, the
+    // widest line's
+    float width(std::string_view text) const;
+    // out[i] is where character i starts when the text is drawn; out[n] is
+    // where one more character would start
+    template <typename Allocator>
+    void offsets(std::string_view text, std::vector<float, Allocator>& out) const {
+        out.resize(text.length() + 1);
+        out[0] = 0.0f;
+        for (size_t i = 0; i < text.length(); i++) {
+            out[i + 1] = out[i] + advance(text[i]) + letterSpacing;
+        }
+    }
+
+private:
+    float advances[128];
+    float letterSpacing;
+};
+
+struct TextLine {
+    size_t start;
+    size_t length;
+};
+
+// Greedy word wrap: a word that doesn't fit starts a new line, carrying its
+// leading space with it. One pass over the text with running advance sums.
+std::vector<TextLine> wrapLines(std::string_view text, float maxWidth, const GlyphMetrics& metrics);
+
+// End of the wrapped line starting at lineStart, where wrapLines would end
+// it. Only needs operator[] and length(), so it also works on a GapBuffer.
+template <typename Text>
+size_t wrappedLineEnd(const Text& text, size_t lineStart, float maxWidth, const GlyphMetrics& metrics) {
+    size_t length = text.length();
+    size_t wordStart = lineStart;
+    float width = 0.0f;  // Of text[lineStart, i)
+    for (size_t i = lineStart; i < length; i++) {
+        char c = text[i];
+        if (c == ' ' || c == '\n') {
+            if (width > maxWidth && wordStart > lineStart) return wordStart;
+            wordStart = i;
+        }
+        width += metrics.advance(c) + (i > lineStart ? metrics.spacing() : 0.0f);
+    }
+
+    if (wordStart < length && width > maxWidth && wordStart > lineStart) return wordStart;
+    return length;
+}
+
+// Wrapped lines of a text, kept between frames. Lines before the one that
+// holds an edit can't change, so an edit at the end of the text only rewraps
+// the last line or two.
+class WrappedText {
+public:
+    void assign(std::string_view text, float maxWidth, const GlyphMetrics& metrics);
+    // Rewraps from the line before the one holding firstChanged
+    void update(std::string_view text, size_t firstChanged);
+
+    // Wraps text that isn't contiguous, a line at a time
+    template <typename Text>
+    void assignLines(const Text& text, float maxWidth, const GlyphMetrics& metrics);
+    // After text[position, position + removed) was replaced by `inserted`
+    // characters: rewraps from the line before the edit until a line starts
+    // where an old one did, then keeps the old lines after it, shifted
+    template <typename Text>
+    void edit(const Text& text, size_t position, size_t removed, size_t inserted);
+
+    const std::vector<TextLine>& lines() const { return wrapped; }
+    float maxWidth() const { return width; }
+    // The line holding index; an index at a line break belongs to the earlier line
+    size_t lineOf(size_t index) const;
+
+private:
+    std::vector<TextLine> wrapped;
+    float width = 0.0f;
+    const GlyphMetrics* metrics = nullptr;
+    std::vector<float> advanceSums;  // Scratch for assign and update, kept for its capacity
+};
+
+template <typename Text>
+void WrappedText::assignLines(const Text& text, float maxWidth, const GlyphMetrics& textMetrics) {
+    width = maxWidth;
+    metrics = &textMetrics;
+    wrapped.clear();
+    for (size_t start = 0; start < text.length();) {
+        size_t end = wrappedLineEnd(text, start, width, *metrics);
+        wrapped.push_back({ start, end - start });
+        start = end;
+    }
+}
+
+template <typename Text>
+void WrappedText::edit(const Text& text, size_t position, size_t removed, size_t inserted) {
+    if (metrics == nullptr) return;
+
+    // An edit can pull the start of its line back onto the line before
+    size_t line = lineOf(position);
+    if (line > 0) line--;
+    line = std::min(line, wrapped.size());
+
+    // From a line start on, wrapping only depends on the text after it, so
+    // past the edit a new line starting where an old one did rejoins them
+    std::vector<TextLine> rewrapped;
+    size_t start = line < wrapped.size() ? wrapped[line].start : 0;
+    size_t next = line;
+    bool rejoined = false;
+    while (start < text.length()) {
+        if (start >= position + inserted) {
+            size_t oldStart = start - inserted + removed;
+            while (next < wrapped.size() && wrapped[next].start < oldStart) next++;
+            if (next < wrapped.size() && wrapped[next].start == oldStart) {
+                rejoined = true;
+                break;
+            }
+        }
+
+        size_t end = wrappedLineEnd(text, start, width, *metrics);
+        rewrapped.push_back({ start, end - start });
+        start = end;
+    }
+    if (!rejoined) next = wrapped.size();
+
+    for (size_t i = next; i < wrapped.size(); i++) {
+        wrapped[i].start = wrapped[i].start + inserted - removed;
+    }
+    wrapped.erase(wrapped.begin() + line, wrapped.begin() + next);
+    wrapped.insert(wrapped.begin() + line, rewrapped.begin(), rewrapped.end());
+}
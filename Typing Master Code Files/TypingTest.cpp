@@ -1,39 +1,42 @@
 #include "TypingTest.h"
+#include "PersistenceQueue.h"
+#include "TextLayout.h"
+#include "FrameStats.h"
+#include "RedrawScheduler.h"
+#include "FrameArena.h"
 #include <sstream>
 #include <fstream>
 #include <cstdlib>
 #include <ctime>
 #include <iostream>
 #include <chrono>
+#include <cmath>
 #include <iomanip>
 
 TypingTest::TypingTest(const std::string& username)
-    : username(username), duration(60), complexity(1), useCustomPassage(false),
-    correctChars(0), totalChars(0), timer(0.0f), customPassage(""),
-    currentWPM(0), currentIndex(0), testActive(true), passageScrollY(0), inputScrollY(0){
+    : currentWPM(0), currentIndex(0), testActive(true), passageScrollY(0), inputScrollY(0),
+    username(username), passageLayoutDirty(true), inputEditStart(0),
+    duration(60), complexity(1), useCustomPassage(false), correctChars(0), totalChars(0), timer(0.0f),
+    keyboardLayoutIndex(0), cachedLayoutIndex(0), keyboardTexture{}, keyboardOrigin{ 0, 0 },
+    keyboardCached(false), keyboardScreenWidth(0), keyboardScreenHeight(0) {
 
     srand(static_cast<unsigned>(time(0)));
+}
 
-    keyboardLayout = {
-        {0, {"`", "1", "2", "3", "4", "5", "6", "7", "8", "9", "0", "-", "=", "?"}},
-        {1, {"Tab", "Q", "W", "E", "R", "T", "Y", "U", "I", "O", "P", "[", "]", "\\"}},
-        {2, {"Caps", "A", "S", "D", "F", "G", "H", "J", "K", "L", ";", "'", "Enter"}},
-        {3, {"Shift", "Z", "X", "C", "V", "B", "N", "M", ",", ".", "/", "Shift"}},
-        {4, {"Ctrl", "Win", "Alt", "Space", "Alt", "Fn", "Menu", "Ctrl"}}
-    };
-
-    specialKeyWidths = {
-        {"?", 2.0f}, {"Tab", 1.5f}, {"Caps", 1.75f}, {"Enter", 2.25f},
-        {"Shift", 2.25f}, {"Space", 6.25f}, {"Ctrl", 1.25f}, {"Alt", 1.25f},
-        {"Win", 1.25f}, {"Fn", 1.25f}, {"Menu", 1.25f}
-    };
+TypingTest::~TypingTest() {
+    if (keyboardCached) {
+        UnloadRenderTexture(keyboardTexture);
+    }
 }
 
 void TypingTest::showCustomPassageInput() {
-    static float cursorBlinkTimer = 0.0f;
     static float scrollOffset = 0.0f;
-    cursorBlinkTimer += GetFrameTime();
-    bool showCursor = (int)(cursorBlinkTimer * 2) % 2 == 0;
+
+    // The cursor blinks on the clock, so an idle editor only needs a frame
+    // each time it changes
+    double blinkPhase = GetTime() * 2;
+    bool showCursor = (long long)blinkPhase % 2 == 0;
+    RedrawScheduler::instance().requestFrameIn((std::floor(blinkPhase) + 1 - blinkPhase) / 2);
 
     const int screenWidth = GetScreenWidth();
     const int containerWidth = 800;
@@ -42,18 +45,27 @@ void TypingTest::showCustomPassageInput() {
     DrawText("Custom Passage", containerX + 40, 360, 24, DARKGRAY);
 
     // Show character count
-    std::string charCount = TextFormat("Characters: %d/1000", customPassage.length());
-    DrawText(charCount.c_str(),
-        containerX + containerWidth - 40 - MeasureText(charCount.c_str(), 20),
+    const char* charCount = FrameArena::instance().format("Characters: %d/%d", (int)customPassage.length(), (int)MAX_CUSTOM_PASSAGE_CHARS);
+    DrawText(charCount,
+        containerX + containerWidth - 40 - MeasureText(charCount, 20),
         360,
         20,
-        customPassage.length() >= 1000 ? RED : DARKGRAY);
+        customPassage.length() >= MAX_CUSTOM_PASSAGE_CHARS ? RED : DARKGRAY);
 
     // Input box with scroll indicators
     Rectangle inputBox = { (float)(containerX + 40), 390, (float)(containerWidth - 80), 120 };
     DrawRectangle(inputBox.x, inputBox.y, inputBox.width, inputBox.height, WHITE);
     DrawRectangleLines(inputBox.x, inputBox.y, inputBox.width, inputBox.height, DARKGRAY);
 
+    // The whole passage is only wrapped when the box width changes; edits
+    // rewrap the lines around them
+    const int fontSize = 20;
+    const int lineHeight = fontSize + 5;
+    const GlyphMetrics& metrics = GlyphMetrics::forDefaultFont(fontSize);
+    if (customLayout.maxWidth() != inputBox.width - 30) {
+        customLayout.assignLines(customPassage, inputBox.width - 30, metrics);
+    }
+
     // Add scroll bar if content exceeds box height
     float maxScroll = calculateMaxScroll(inputBox);
     if (maxScroll > 0) {
@@ -108,19 +120,28 @@ void TypingTest::showCustomPassageInput() {
         selectionEnd = customPassage.length();
     }
 
-    const int fontSize = 20;
-    const int lineHeight = fontSize + 5;
     float textX = inputBox.x + 10;
     float textY = inputBox.y + 10 - scrollOffset;
 
-    // Draw text with wrapping and selection highlighting
-    std::vector<std::string> lines = wrapText(customPassage, inputBox.width - 30, fontSize);
-    size_t currentPos = 0;
-
-    for (const std::string& line : lines) {
+    // Draw text with wrapping and selection highlighting. Every line is
+    // lineHeight tall, so the scroll offset picks out the visible lines
+    // directly and only those are copied out of the buffer and drawn.
+    const std::vector<TextLine>& lines = customLayout.lines();
+    size_t firstLine = (size_t)std::max(0.0f, (inputBox.y - textY) / lineHeight);
+    size_t lastLine = std::min(lines.size(), (size_t)((inputBox.y + inputBox.height - textY) / lineHeight) + 1);
+    FrameVector<float> lineOffsets;
+
+    for (size_t row = firstLine; row < lastLine; row++) {
+        const TextLine& line = lines[row];
+        float lineY = textY + row * lineHeight;
+        char* lineChars = static_cast<char*>(FrameArena::instance().allocate(line.length + 1, 1));
+        customPassage.copy(lineChars, line.length, line.start);
+        lineChars[line.length] = '\0';
+        std::string_view lineText(lineChars, line.length);
+        metrics.offsets(lineText, lineOffsets);
         if (selectionStart != selectionEnd) {
-            size_t lineStart = currentPos;
-            size_t lineEnd = currentPos + line.length();
+            size_t lineStart = line.start;
+            size_t lineEnd = line.start + line.length;
 
             if (lineStart < std::max(selectionStart, selectionEnd) &&
                 lineEnd > std::min(selectionStart, selectionEnd)) {
@@ -128,27 +149,23 @@ void TypingTest::showCustomPassageInput() {
                 size_t highlightStart = std::max(lineStart, std::min(selectionStart, selectionEnd));
                 size_t highlightEnd = std::min(lineEnd, std::max(selectionStart, selectionEnd));
 
-                std::string beforeHighlight = line.substr(0, highlightStart - lineStart);
-                std::string highlightText = line.substr(highlightStart - lineStart, highlightEnd - highlightStart);
+                std::string_view highlightText = lineText.substr(highlightStart - lineStart, highlightEnd - highlightStart);
 
-                float highlightX = textX + MeasureText(beforeHighlight.c_str(), fontSize);
-                float highlightWidth = MeasureText(highlightText.c_str(), fontSize);
+                float highlightX = textX + lineOffsets[highlightStart - lineStart];
+                float highlightWidth = metrics.width(highlightText);
 
-                DrawRectangle(highlightX, textY, highlightWidth, lineHeight, { 0, 120, 215, 255 });
-                DrawText(highlightText.c_str(), highlightX, textY, fontSize, WHITE);
+                DrawRectangle(highlightX, lineY, highlightWidth, lineHeight, { 0, 120, 215, 255 });
+                drawTextRun(highlightText, highlightX, lineY, fontSize, WHITE);
             }
         }
 
-        DrawText(line.c_str(), textX, textY, fontSize, BLACK);
+        DrawText(lineChars, textX, lineY, fontSize, BLACK);
 
         // Draw cursor
-        if (showCursor && currentPos + line.length() >= selectionStart && currentPos <= selectionStart) {
-            float cursorX = textX + MeasureText(line.substr(0, selectionStart - currentPos).c_str(), fontSize);
-            DrawRectangle(cursorX, textY, 2, fontSize, BLACK);
+        if (showCursor && customLayout.lineOf(selectionStart) == row && selectionStart >= line.start) {
+            float cursorX = textX + lineOffsets[std::min(selectionStart - line.start, line.length)];
+            DrawRectangle(cursorX, lineY, 2, fontSize, BLACK);
         }
-
-        textY += lineHeight;
-        currentPos += line.length();
     }
 
     EndScissorMode();
@@ -159,7 +176,8 @@ void TypingTest::showCustomPassageInput() {
 
     // Auto-scroll to cursor if it's outside visible area
     if (oldLength != customPassage.length()) {
-        float cursorY = (selectionStart / (float)customPassage.length()) * maxScroll;
+        maxScroll = calculateMaxScroll(inputBox);
+        float cursorY = customLayout.lineOf(selectionStart) * (float)lineHeight;
         if (cursorY < scrollOffset) {
             scrollOffset = cursorY;
         }
@@ -169,81 +187,6 @@ void TypingTest::showCustomPassageInput() {
         scrollOffset = Clamp(scrollOffset, 0.0f, maxScroll);
     }
 }
-/*void TypingTest::displayPassage() {
-    const int margin = 50;
-    const int maxWidth = GetScreenWidth() - 2 * margin;
-    const int fontSize = 20;
-    const int lineHeight = fontSize + 10;
-    const int letterSpacing = 2;
-
-    // Improved container with better visibility
-    DrawRectangle(margin - 10, 70, GetScreenWidth() - 2 * (margin - 10), 300, RAYWHITE);
-    DrawRectangleLines(margin - 10, 70, GetScreenWidth() - 2 * (margin - 10), 300, LIGHTGRAY);
-
-    // Enhanced WPM display
-    std::string wpmText = TextFormat("Current WPM: %d", currentWPM);
-    Color wpmColor = currentWPM > 60 ? GREEN : (currentWPM > 30 ? ORANGE : DARKGRAY);
-    DrawText(wpmText.c_str(), GetScreenWidth() - 200, 30, 24, wpmColor);
-
-    // Improved passage display with better readability
-    DrawText("Type this:", margin, 90, 24, DARKGRAY);
-
-    std::vector<std::string> lines = wrapText(passage, maxWidth, fontSize);
-    int y = 140;
-    size_t totalCharsDrawn = 0;
-
-    for (const std::string& line : lines) {
-        int x = margin;
-        for (size_t i = 0; i < line.length(); i++) {
-            char c = line[i];
-            Color charColor;
-
-            if (totalCharsDrawn == currentIndex) {
-                // Current character to type (more visible cursor)
-                DrawRectangle(x, y, MeasureText(&c, fontSize), fontSize, { 0, 120, 215, 64 });
-                charColor = BLUE;
-            }
-            else if (totalCharsDrawn < currentIndex) {
-                // Typed characters (with success/error indication)
-                if (totalCharsDrawn < userInput.length() && userInput[totalCharsDrawn] == c) {
-                    charColor = GREEN;
-                }
-                else {
-                    charColor = RED;
-                }
-            }
-            else {
-                // Upcoming characters
-                charColor = GRAY;
-            }
-
-            std::string charStr(1, c);
-            DrawText(charStr.c_str(), x, y, fontSize, charColor);
-            x += MeasureText(charStr.c_str(), fontSize) + letterSpacing;
-            totalCharsDrawn++;
-        }
-        y += lineHeight;
-    }
-
-    // Enhanced user input display
-    DrawText("Your input:", margin, y + 20, 24, DARKGRAY);
-    y += lineHeight + 20;
-
-    // Draw user input with improved visibility
-    std::vector<std::string> inputLines = wrapText(userInput, maxWidth, fontSize);
-    for (const std::string& line : inputLines) {
-        int x = margin;
-        for (size_t i = 0; i < line.length(); i++) {
-            char c = line[i];
-            Color charColor = (i < passage.length() && c == passage[i]) ? GREEN : RED;
-            std::string charStr(1, c);
-
-            DrawText(charStr.c_str(), x, y, fontSize, charColor);
-            x += MeasureText(charStr.c_str(), fontSize) + letterSpacing;
-        }
-        y += lineHeight;
-    }
-}*/
 
 // Helper function to check if text is selected
 bool TypingTest::isTextSelected(size_t start, size_t end, size_t selStart, size_t selEnd) {
@@ -251,13 +194,13 @@ bool TypingTest::isTextSelected(size_t start, size_t end, size_t selStart, size_
     size_t selectionEnd = std::max(selStart, selEnd);
     return (start < selectionEnd && end > selectionStart);
 }void TypingTest::handleTextInput(size_t& selectionStart, size_t& selectionEnd) {
-    const size_t MAX_CHARS = 1000; // Maximum characters allowed
+    const size_t MAX_CHARS = MAX_CUSTOM_PASSAGE_CHARS; // Maximum characters allowed
 
     // Handle Ctrl+C (Copy)
     if (IsKeyDown(KEY_LEFT_CONTROL) && IsKeyPressed(KEY_C)) {
         if (selectionStart != selectionEnd) {
             size_t start = std::min(selectionStart, selectionEnd);
-            size_t length = std::abs((int)(selectionEnd - selectionStart));
+            size_t length = std::max(selectionStart, selectionEnd) - std::min(selectionStart, selectionEnd);
             std::string selectedText = customPassage.substr(start, length);
             SetClipboardText(selectedText.c_str());
         }
@@ -279,7 +222,7 @@ bool TypingTest::isTextSelected(size_t start, size_t end, size_t selStart, size_
 
             // Calculate available space
             size_t availableSpace = MAX_CHARS - (customPassage.length() -
-                (selectionEnd > selectionStart ? selectionEnd - selectionStart : selectionStart - selectionEnd));
+                (std::max(selectionStart, selectionEnd) - std::min(selectionStart, selectionEnd)));
 
             // Truncate if necessary
             if (newText.length() > availableSpace) {
@@ -289,13 +232,13 @@ bool TypingTest::isTextSelected(size_t start, size_t end, size_t selStart, size_
             if (selectionStart != selectionEnd) {
                 // Delete selected text before pasting
                 size_t start = std::min(selectionStart, selectionEnd);
-                size_t length = std::abs((int)(selectionEnd - selectionStart));
-                customPassage.erase(start, length);
+                size_t length = std::max(selectionStart, selectionEnd) - std::min(selectionStart, selectionEnd);
+                editCustomPassage(start, length, "");
                 selectionEnd = selectionStart = start;
             }
 
             if (selectionStart <= customPassage.length() && !newText.empty()) {
-                customPassage.insert(selectionStart, newText);
+                editCustomPassage(selectionStart, 0, newText);
                 selectionStart = selectionEnd = selectionStart + newText.length();
             }
         }
@@ -305,18 +248,18 @@ bool TypingTest::isTextSelected(size_t start, size_t end, size_t selStart, size_
     if (IsKeyPressed(KEY_BACKSPACE) || IsKeyPressed(KEY_DELETE)) {
         if (selectionStart != selectionEnd) {
             size_t start = std::min(selectionStart, selectionEnd);
-            size_t length = std::abs((int)(selectionEnd - selectionStart));
+            size_t length = std::max(selectionStart, selectionEnd) - std::min(selectionStart, selectionEnd);
             if (start < customPassage.length()) {
-                customPassage.erase(start, length);
+                editCustomPassage(start, length, "");
                 selectionStart = selectionEnd = start;
             }
         }
         else if (IsKeyPressed(KEY_BACKSPACE) && selectionStart > 0) {
-            customPassage.erase(selectionStart - 1, 1);
+            editCustomPassage(selectionStart - 1, 1, "");
             selectionStart = selectionEnd = selectionStart - 1;
         }
         else if (IsKeyPressed(KEY_DELETE) && selectionStart < customPassage.length()) {
-            customPassage.erase(selectionStart, 1);
+            editCustomPassage(selectionStart, 1, "");
         }
     }
 
@@ -326,14 +269,15 @@ bool TypingTest::isTextSelected(size_t start, size_t end, size_t selStart, size_
         if ((key >= 32) && (key <= 125) && customPassage.length() < MAX_CHARS) {
             if (selectionStart != selectionEnd) {
                 size_t start = std::min(selectionStart, selectionEnd);
-                size_t length = std::abs((int)(selectionEnd - selectionStart));
+                size_t length = std::max(selectionStart, selectionEnd) - std::min(selectionStart, selectionEnd);
                 if (start < customPassage.length()) {
-                    customPassage.erase(start, length);
+                    editCustomPassage(start, length, "");
                 }
                 selectionEnd = selectionStart = start;
             }
             if (selectionStart <= customPassage.length()) {
-                customPassage.insert(selectionStart, 1, (char)key);
+                char c = (char)key;
+                editCustomPassage(selectionStart, 0, std::string_view(&c, 1));
                 selectionStart = selectionEnd = selectionStart + 1;
             }
         }
@@ -358,82 +302,52 @@ bool TypingTest::isTextSelected(size_t start, size_t end, size_t selStart, size_
         }
     }
 }
+// Replaces customPassage[position, position + removed) with inserted and
+// rewraps only the lines the edit touched
+void TypingTest::editCustomPassage(size_t position, size_t removed, std::string_view inserted) {
+    removed = std::min(removed, customPassage.length() - std::min(position, customPassage.length()));
+    customPassage.erase(position, removed);
+    customPassage.insert(position, inserted);
+    customLayout.edit(customPassage, position, removed, inserted.length());
+}
+
 // Helper functions
 size_t TypingTest::getTextPositionFromMouse(Vector2 mousePos, Rectangle inputBox, float scrollOffset) {
     const int fontSize = 20;
+    const int lineHeight = fontSize + 5;
     float textX = inputBox.x + 10;
     float textY = inputBox.y + 10 - scrollOffset;
 
-    std::vector<std::string> lines = wrapText(customPassage, inputBox.width - 20, fontSize);
-    size_t currentPos = 0;
-
-    for (const std::string& line : lines) {
-        if (mousePos.y >= textY && mousePos.y < textY + fontSize + 5) {
-            float charX = textX;
-            for (size_t i = 0; i <= line.length(); i++) {
-                if (mousePos.x < charX) {
-                    return currentPos + i;
-                }
-                if (i < line.length()) {
-                    charX += MeasureText(line.substr(i, 1).c_str(), fontSize);
-                }
-            }
-            return currentPos + line.length();
-        }
-        textY += fontSize + 5;
-        currentPos += line.length();
-    }
-    return customPassage.length();
+    // customLayout is wrapped at the drawing code's width, so clicks land
+    // where the text is. Lines are evenly spaced, so the row is a division.
+    const GlyphMetrics& metrics = GlyphMetrics::forDefaultFont(fontSize);
+    const std::vector<TextLine>& lines = customLayout.lines();
+    if (mousePos.y < textY) return customPassage.length();
+    size_t row = static_cast<size_t>((mousePos.y - textY) / lineHeight);
+    if (row >= lines.size()) return customPassage.length();
+
+    // Then a binary search for the first character that starts right of the mouse
+    const TextLine& line = lines[row];
+    char* lineChars = static_cast<char*>(FrameArena::instance().allocate(line.length, 1));
+    customPassage.copy(lineChars, line.length, line.start);
+    FrameVector<float> lineOffsets;
+    metrics.offsets(std::string_view(lineChars, line.length), lineOffsets);
+    size_t column = std::upper_bound(lineOffsets.begin(), lineOffsets.end(), mousePos.x - textX) - lineOffsets.begin();
+    return line.start + std::min(column, line.length);
 }
 
 float TypingTest::calculateMaxScroll(Rectangle inputBox) {
     const int fontSize = 20;
     const int lineHeight = fontSize + 5;
-    std::vector<std::string> lines = wrapText(customPassage, inputBox.width - 20, fontSize);
-    float totalHeight = lines.size() * lineHeight;
+    float totalHeight = customLayout.lines().size() * lineHeight;
     return std::max(0.0f, totalHeight - inputBox.height);
 }
 
-std::vector<std::string> TypingTest::wrapText(const std::string& text, float maxWidth, int fontSize) {
-    std::vector<std::string> lines;
-    std::string currentLine;
-    std::string currentWord;
-
-    for (size_t i = 0; i < text.length(); i++) {
-        if (text[i] == ' ' || text[i] == '\n') {
-            if (MeasureText((currentLine + currentWord).c_str(), fontSize) <= maxWidth) {
-                currentLine += currentWord;
-                currentWord = text[i];
-            }
-            else {
-                if (!currentLine.empty()) {
-                    lines.push_back(currentLine);
-                }
-                currentLine = currentWord;
-                currentWord = text[i];
-            }
-        }
-        else {
-            currentWord += text[i];
-        }
-    }
-
-    if (!currentWord.empty()) {
-        if (MeasureText((currentLine + currentWord).c_str(), fontSize) <= maxWidth) {
-            currentLine += currentWord;
-        }
-        else {
-            if (!currentLine.empty()) {
-                lines.push_back(currentLine);
-            }
-            currentLine = currentWord;
-        }
-    }
-
-    if (!currentLine.empty()) {
-        lines.push_back(currentLine);
+FrameVector<std::string_view> TypingTest::wrapText(std::string_view text, float maxWidth, int fontSize) {
+    FrameVector<std::string_view> lines;
+    for (const TextLine& line : wrapLines(text, maxWidth, GlyphMetrics::forDefaultFont(fontSize))) {
+        lines.push_back(text.substr(line.start, line.length));
     }
-
     return lines;
 }
 
@@ -442,14 +356,14 @@ void TypingTest::displayPassage() {
     const int maxWidth = GetScreenWidth() - 2 * margin;
     const int fontSize = 20;
     const int lineHeight = fontSize + 10;
-    const int letterSpacing = 2;
     const int boxHeight = 120; // For 4 lines
+    const GlyphMetrics& metrics = GlyphMetrics::forDefaultFont(fontSize);
 
     // Draw WPM and Timer with consistent positioning and size
     const int statusY = 20;  // Vertical position for status items
 
-    std::string wpmText = TextFormat("Current WPM: %d", currentWPM);
-    DrawText(wpmText.c_str(), GetScreenWidth() - 220, statusY, 24, DARKGRAY);
+    const char* wpmText = FrameArena::instance().format("Current WPM: %d", currentWPM);
+    DrawText(wpmText, GetScreenWidth() - 220, statusY, 24, DARKGRAY);
 
     // Adjust vertical positioning
     int passageBoxY = statusY + 50;  // Added gap after timer
@@ -467,8 +381,12 @@ void TypingTest::displayPassage() {
 
     DrawText("Type this:", margin, passageBoxY - 25, 20, DARKGRAY);
 
-    // Calculate passage content and scrolling
-    std::vector<std::string> lines = wrapText(passage, maxWidth - 20, fontSize);
+    // The passage is wrapped once per test (or window width), not per frame
+    if (passageLayoutDirty || passageLayout.maxWidth() != maxWidth - 20) {
+        passageLayout.assign(passage, maxWidth - 20, metrics);
+        passageLayoutDirty = false;
+    }
+    const std::vector<TextLine>& lines = passageLayout.lines();
     float totalPassageHeight = lines.size() * lineHeight;
     float maxPassageScroll = std::max(0.0f, totalPassageHeight - (boxHeight - 20));
 
@@ -477,18 +395,7 @@ void TypingTest::displayPassage() {
         passageScrollY = 0;
     }
     else {
-        // Find the current line and character position
-        int currentLine = 0;
-        int charsInPreviousLines = 0;
-
-        // Calculate which line we're on and how many characters came before
-        for (size_t i = 0; i < lines.size(); i++) {
-            if (charsInPreviousLines + lines[i].length() >= currentIndex) {
-                currentLine = i;
-                break;
-            }
-            charsInPreviousLines += lines[i].length();
-        }
+        size_t currentLine = passageLayout.lineOf(currentIndex);
 
         // Adjust scroll position to keep current line visible
         float desiredScrollY = (currentLine * lineHeight) - (boxHeight / 3);
@@ -502,35 +409,26 @@ void TypingTest::displayPassage() {
         DrawRectangle(passageBox.x + passageBox.width - 8, scrollBarY, 8, scrollBarHeight, GRAY);
     }
 
-    // Draw passage text with fixed character highlighting
+    // Draw passage text with fixed character highlighting; only the lines
+    // that fall inside the box are visited, each as at most three runs
     BeginScissorMode(margin, passageBoxY, maxWidth, boxHeight);
-    int charsDrawn = 0;
-    float y = passageBoxY + 10 - passageScrollY;
-
-    for (const std::string& line : lines) {
-        if (y + lineHeight >= passageBoxY && y <= passageBoxY + boxHeight) {
-            float x = margin;
-            for (size_t i = 0; i < line.length(); i++) {
-                char c = line[i];
-                Color charColor = GRAY;
-
-                if (charsDrawn == currentIndex) {
-                    charColor = BLUE;  // Just change color instead of highlighting
-                }
-                else if (charsDrawn < currentIndex) {
-                    charColor = LIGHTGRAY;
-                }
+    size_t firstLine = (size_t)std::max(0.0f, (passageScrollY - 10) / lineHeight);
+    int textDraws = 0;
+    auto passageColor = [this](size_t index) {
+        if (index == currentIndex) return BLUE;  // Just change color instead of highlighting
+        if (index < currentIndex) return LIGHTGRAY;
+        return GRAY;
+    };
 
-                std::string charStr(1, c);
-                DrawText(charStr.c_str(), x, y, fontSize, charColor);
-                x += MeasureText(charStr.c_str(), fontSize) + letterSpacing;
-                charsDrawn++;
-            }
-        }
-        else {
-            charsDrawn += line.length();
+    for (size_t row = firstLine; row < lines.size(); row++) {
+        float y = passageBoxY + 10 - passageScrollY + row * lineHeight;
+        if (y > passageBoxY + boxHeight) break;
+
+        if (y + lineHeight >= passageBoxY) {
+            const TextLine& line = lines[row];
+            textDraws += drawColoredRuns(passage, line.start, line.start + line.length,
+                margin, y, fontSize, metrics, passageColor);
         }
-        y += lineHeight;
     }
     EndScissorMode();
 
@@ -546,8 +444,16 @@ void TypingTest::displayPassage() {
 
     DrawText("Your input:", margin, inputBoxY - 25, 20, DARKGRAY);
 
-    // Calculate input content and scrolling
-    std::vector<std::string> inputLines = wrapText(userInput, maxWidth - 20, fontSize);
+    // Typing only touches the end of the input, so only its last lines are rewrapped
+    if (inputLayout.maxWidth() != maxWidth - 20) {
+        inputLayout.assign(userInput, maxWidth - 20, metrics);
+    }
+    else if (inputEditStart != std::string::npos) {
+        inputLayout.update(userInput, inputEditStart);
+    }
+    inputEditStart = std::string::npos;
+
+    const std::vector<TextLine>& inputLines = inputLayout.lines();
     float totalInputHeight = inputLines.size() * lineHeight;
     float maxInputScroll = std::max(0.0f, totalInputHeight - (boxHeight - 20));
 
@@ -564,35 +470,28 @@ void TypingTest::displayPassage() {
     }
 
     BeginScissorMode(margin, inputBoxY, maxWidth, boxHeight);
-    float inputY = inputBoxY + 10 - inputScrollY;
-    size_t totalInputChars = 0;
-
-    for (const std::string& line : inputLines) {
-        if (inputY + lineHeight >= inputBoxY && inputY <= inputBoxY + boxHeight) {
-            float x = margin;
-            for (size_t i = 0; i < line.length(); i++) {
-                char c = line[i];
-                Color charColor = GRAY;
-
-                // Only check characters that have a corresponding position in the passage
-                if (totalInputChars < passage.length()) {
-                    if (totalInputChars < userInput.length()) {  // Only check characters that have been typed
-                        charColor = (c == passage[totalInputChars]) ? GREEN : RED;
-                    }
-                }
-
-                std::string charStr(1, c);
-                DrawText(charStr.c_str(), x, inputY, fontSize, charColor);
-                x += MeasureText(charStr.c_str(), fontSize) + letterSpacing;
-                totalInputChars++;
-            }
+    size_t firstInputLine = (size_t)std::max(0.0f, (inputScrollY - 10) / lineHeight);
+    auto inputColor = [this](size_t index) {
+        // Only characters that have a corresponding position in the passage are checked
+        if (index < passage.length()) {
+            return (userInput[index] == passage[index]) ? GREEN : RED;
         }
-        else {
-            totalInputChars += line.length();
+        return GRAY;
+    };
+
+    for (size_t row = firstInputLine; row < inputLines.size(); row++) {
+        float inputY = inputBoxY + 10 - inputScrollY + row * lineHeight;
+        if (inputY > inputBoxY + boxHeight) break;
+
+        if (inputY + lineHeight >= inputBoxY) {
+            const TextLine& line = inputLines[row];
+            textDraws += drawColoredRuns(userInput, line.start, line.start + line.length,
+                margin, inputY, fontSize, metrics, inputColor);
         }
-        inputY += lineHeight;
     }
     EndScissorMode();
+
+    FrameStats::instance().countDrawCalls(textDraws);
 }
 void TypingTest::update() {
     if (testActive) {
@@ -630,6 +529,9 @@ void TypingTest::drawMainMenu() {
     }
 
 
+    // Keyboard layout in the top-left corner; clicking cycles through them
+    drawButton(20, 20, 200, 40, FrameArena::instance().format("Keyboard: %s", KEYBOARD_LAYOUTS[keyboardLayoutIndex].name), false);
+
     // Title
     DrawText("Typing Test", centerX - MeasureText("Typing Test", 50) / 2, 50, 50, BLACK);
 
@@ -680,26 +582,17 @@ void TypingTest::drawMainMenu() {
     }
 }
 
-void TypingTest::drawButton(int x, int y, int width, int height, const std::string& text, bool isSelected) {
+void TypingTest::drawButton(int x, int y, int width, int height, const char* text, bool isSelected) {
     Rectangle buttonRect = { (float)x, (float)y, (float)width, (float)height };
     bool isHovered = CheckCollisionPointRec(GetMousePosition(), buttonRect);
 
     DrawRectangle(x, y, width, height, isSelected ? BLACK : (isHovered ? LIGHTGRAY : WHITE));
     DrawRectangleLines(x, y, width, height, isSelected ? WHITE : DARKGRAY);
 
-    int textWidth = MeasureText(text.c_str(), 20);
+    int textWidth = MeasureText(text, 20);
     int textX = x + (width - textWidth) / 2;
     int textY = y + (height - 20) / 2;
-    DrawText(text.c_str(), textX, textY, 20, isSelected ? WHITE : BLACK);
-}
-
-float TypingTest::calculateRowWidth(const std::vector<std::string>& row, float baseKeyWidth, float spacing) {
-    float totalWidth = 0;
-    for (const std::string& key : row) {
-        float keyWidth = baseKeyWidth * (specialKeyWidths.count(key) ? specialKeyWidths[key] : 1.0f);
-        totalWidth += keyWidth + spacing;
-    }
-    return totalWidth - spacing;
+    DrawText(text, textX, textY, 20, isSelected ? WHITE : BLACK);
 }
 
 void TypingTest::updateWPM() {
@@ -717,6 +610,10 @@ void TypingTest::handleMenuInput() {
     const int columnWidth = containerWidth / 3 - 40;
 
     if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+        // Keyboard layout button
+        if (CheckCollisionPointRec(mousePos, { 20, 20, 200, 40 }))
+            keyboardLayoutIndex = (keyboardLayoutIndex + 1) % KEYBOARD_LAYOUT_COUNT;
+
         // Duration buttons
         if (CheckCollisionPointRec(mousePos, { (float)(containerX + 40), 200, (float)columnWidth, 40 }))
             duration = 30;
@@ -763,7 +660,7 @@ void TypingTest::startTest() {
     std::vector<std::string> allPassages;
 
     if (useCustomPassage) {
-        allPassages.push_back(customPassage);
+        allPassages.push_back(customPassage.str());
     }
     else {
         std::ifstream file(filePath);
@@ -784,13 +681,17 @@ void TypingTest::startTest() {
 
     bool testCompleted = false;
     passage = allPassages[currentPassageIndex];
+    passageLayoutDirty = true;
+    inputEditStart = 0;
     testActive = true;
 
     while (!WindowShouldClose() && timer > 0 && !testCompleted && testActive) {
+        RedrawScheduler::instance().waitForFrame();
         timer -= GetFrameTime();
 
         BeginDrawing();
         ClearBackground(RAYWHITE);
+        RedrawScheduler::instance().requestFrame();  // The timer counts down
 
         renderTimer();
         displayPassage();
@@ -812,9 +713,12 @@ void TypingTest::startTest() {
                 passage = allPassages[currentPassageIndex];
                 userInput.clear();
                 currentIndex = 0;
+                passageLayoutDirty = true;
+                inputEditStart = 0;
             }
         }
 
+        FrameStats::instance().finishFrame();
         EndDrawing();
 
         if (returnToMenu) {
@@ -847,12 +751,14 @@ void TypingTest::renderExitButton() {
 void TypingTest::displayMainMenu() {
     testActive = true;
     while (testActive && !WindowShouldClose()) {
+        RedrawScheduler::instance().waitForFrame();
         BeginDrawing();
         ClearBackground(LIGHTGRAY);
 
         drawMainMenu();
         handleMenuInput();
 
+        FrameStats::instance().finishFrame();
         EndDrawing();
 
         if (IsKeyPressed(KEY_ESCAPE)) {
@@ -870,6 +776,7 @@ void TypingTest::handleKeyPress() {
     int key = GetCharPressed();
     while (key > 0) {
         if ((key >= 32) && (key <= 125)) {
+            inputEditStart = std::min(inputEditStart, userInput.length());
             userInput += static_cast<char>(key);
             totalChars++;
             if (userInput.length() <= passage.length() &&
@@ -889,12 +796,14 @@ void TypingTest::handleKeyPress() {
             currentIndex--;
         }
         userInput.pop_back();
+        inputEditStart = std::min(inputEditStart, userInput.length());
         if (totalChars > 0) totalChars--;
         updateWPM();
     }
 
     if (IsKeyPressed(KEY_SPACE)) {
         if (userInput.empty() || userInput.back() != ' ') {
+            inputEditStart = std::min(inputEditStart, userInput.length());
             userInput += " ";
             totalChars++;
             if (userInput.length() <= passage.length() &&
@@ -907,41 +816,82 @@ void TypingTest::handleKeyPress() {
     }
 }
 
-void TypingTest::renderKeyboard() {
+void TypingTest::buildKeyboardCache() {
     const float baseKeyWidth = 50;
     const float keyHeight = 50;
     const float spacing = 4;
-    const int startY = GetScreenHeight() - (5 * (keyHeight + spacing)) - 50;
+    const float padding = 2;  // Room for the key shadows and outlines
+    const int startY = GetScreenHeight() - (KEYBOARD_ROWS * (keyHeight + spacing)) - 50;
+    const KeyboardLayout& layout = KEYBOARD_LAYOUTS[keyboardLayoutIndex];
 
-    float currentY = startY;
+    auto rowWidth = [&](KeyRow row) {
+        return rowUnits(row) * baseKeyWidth + (row.count - 1) * spacing;
+    };
 
-    for (const auto& row : keyboardLayout) {
-        float rowWidth = calculateRowWidth(row.second, baseKeyWidth, spacing);
-        float currentX = (GetScreenWidth() - rowWidth) / 2;
+    float keyboardWidth = 0;
+    for (const KeyRow& row : layout.rows) {
+        keyboardWidth = std::max(keyboardWidth, rowWidth(row));
+    }
+    float keyboardHeight = KEYBOARD_ROWS * (keyHeight + spacing) - spacing;
 
-        for (const std::string& key : row.second) {
-            float keyWidth = baseKeyWidth * (specialKeyWidths.count(key) ? specialKeyWidths[key] : 1.0f);
-            Rectangle keyRect = { currentX, currentY, keyWidth, keyHeight };
+    // Whole pixels, so the texture maps onto the screen one to one
+    keyboardOrigin = {
+        floorf((GetScreenWidth() - keyboardWidth) / 2 - padding),
+        floorf(startY - padding)
+    };
 
-            bool isPressed = false;
-            if (key.length() == 1) {
-                isPressed = IsKeyDown(static_cast<int>(key[0]));
-            }
-            else {
-                if (key == "Space") isPressed = IsKeyDown(KEY_SPACE);
-                else if (key == "?") isPressed = IsKeyDown(KEY_BACKSPACE);
-                else if (key == "Enter") isPressed = IsKeyDown(KEY_ENTER);
-                else if (key == "Tab") isPressed = IsKeyDown(KEY_TAB);
-                else if (key == "Shift") isPressed = IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT);
-                else if (key == "Ctrl") isPressed = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
-                else if (key == "Alt") isPressed = IsKeyDown(KEY_LEFT_ALT) || IsKeyDown(KEY_RIGHT_ALT);
-            }
+    keyCaps.clear();
+    float currentY = startY;
+    for (const KeyRow& row : layout.rows) {
+        float currentX = (GetScreenWidth() - rowWidth(row)) / 2;
 
-            DrawKey(keyRect, key.c_str(), isPressed);
+        for (size_t i = 0; i < row.count; i++) {
+            const KeyDef& key = row.keys[i];
+            float keyWidth = baseKeyWidth * key.width;
+            keyCaps.push_back({ { currentX, currentY, keyWidth, keyHeight }, &key });
             currentX += keyWidth + spacing;
         }
         currentY += keyHeight + spacing;
     }
+
+    if (keyboardCached) {
+        UnloadRenderTexture(keyboardTexture);
+    }
+    keyboardTexture = LoadRenderTexture((int)ceilf(keyboardWidth + 2 * padding) + 1,
+        (int)ceilf(keyboardHeight + 2 * padding) + 1);
+    keyboardCached = true;
+    keyboardScreenWidth = GetScreenWidth();
+    keyboardScreenHeight = GetScreenHeight();
+    cachedLayoutIndex = keyboardLayoutIndex;
+
+    // The test screen's background is baked in, so key edges blend exactly
+    // as they did when drawn straight to the screen
+    BeginTextureMode(keyboardTexture);
+    ClearBackground(RAYWHITE);
+    for (const KeyCap& cap : keyCaps) {
+        Rectangle local = { cap.rect.x - keyboardOrigin.x, cap.rect.y - keyboardOrigin.y, cap.rect.width, cap.rect.height };
+        DrawKey(local, cap.key->label, false);
+    }
+    EndTextureMode();
+}
+
+void TypingTest::renderKeyboard() {
+    if (!keyboardCached || cachedLayoutIndex != keyboardLayoutIndex ||
+        keyboardScreenWidth != GetScreenWidth() || keyboardScreenHeight != GetScreenHeight()) {
+        buildKeyboardCache();
+    }
+
+    // Render textures are stored upside down, hence the negative height
+    Rectangle source = { 0, 0, (float)keyboardTexture.texture.width, -(float)keyboardTexture.texture.height };
+    DrawTextureRec(keyboardTexture.texture, source, keyboardOrigin, WHITE);
+
+    // Only the keys held down this frame are drawn again
+    for (const KeyCap& cap : keyCaps) {
+        if ((cap.key->keyCode != KEY_NULL && IsKeyDown(cap.key->keyCode)) ||
+            (cap.key->altKeyCode != KEY_NULL && IsKeyDown(cap.key->altKeyCode))) {
+            DrawKey(cap.rect, cap.key->label, true);
+        }
+    }
 }
 
 void TypingTest::DrawKey(Rectangle keyRect, const char* key, bool isPressed) {
@@ -963,23 +913,18 @@ void TypingTest::DrawKey(Rectangle keyRect, const char* key, bool isPressed) {
 void TypingTest::showResults() {
     bool resultScreenActive = true;
     while (!WindowShouldClose() && resultScreenActive) {
+        RedrawScheduler::instance().waitForFrame();
         BeginDrawing();
         ClearBackground(RAYWHITE);
 
         const int centerX = GetScreenWidth() / 2;
         DrawText("Test Completed!", centerX - MeasureText("Test Completed!", 40) / 2, 50, 40, DARKGREEN);
 
-        std::string wpmText = TextFormat("Words Per Minute (WPM): %d", calculateWPM());
-        DrawText(wpmText.c_str(), 50, 150, 30, DARKGRAY);
-
-        std::string accuracyText = TextFormat("Accuracy: %.1f%%", calculateAccuracy());
-        DrawText(accuracyText.c_str(), 50, 200, 30, DARKGRAY);
-
-        std::string correctCharsText = TextFormat("Correct Characters: %d", correctChars);
-        DrawText(correctCharsText.c_str(), 50, 250, 30, DARKGRAY);
-
-        std::string totalCharsText = TextFormat("Total Characters: %d", totalChars);
-        DrawText(totalCharsText.c_str(), 50, 300, 30, DARKGRAY);
+        FrameArena& arena = FrameArena::instance();
+        DrawText(arena.format("Words Per Minute (WPM): %d", calculateWPM()), 50, 150, 30, DARKGRAY);
+        DrawText(arena.format("Accuracy: %.1f%%", calculateAccuracy()), 50, 200, 30, DARKGRAY);
+        DrawText(arena.format("Correct Characters: %d", correctChars), 50, 250, 30, DARKGRAY);
+        DrawText(arena.format("Total Characters: %d", totalChars), 50, 300, 30, DARKGRAY);
 
         DrawText("Press [ESC] to return to Typing Test", 50, 400, 20, DARKGRAY);
 
@@ -995,6 +940,7 @@ void TypingTest::showResults() {
             displayMainMenu();  // Return to typing test menu
         }
 
+        FrameStats::instance().finishFrame();
         EndDrawing();
     }
 }
@@ -1032,24 +978,27 @@ std::string TypingTest::getRandomPassage(const std::string& filePath) {
 }
 
 void TypingTest::saveStats() {
-    std::ofstream file("typing_history.txt", std::ios::app);
-    if (file.is_open()) {
-        auto now = std::chrono::system_clock::now();
-        auto time = std::chrono::system_clock::to_time_t(now);
-
-        struct tm timeinfo;
-        localtime_s(&timeinfo, &time);
-
-        std::stringstream ss;
-        ss << std::put_time(&timeinfo, "%Y-%m-%d %H:%M:%S");
-
-        file << "User: " << username << "\n";
-        file << "Date: " << ss.str() << "\n";
-        file << "WPM: " << calculateWPM() << "\n";
-        file << "Accuracy: " << calculateAccuracy() << "%\n";
-        file << "Duration: " << duration << " seconds\n";
-        file << "Difficulty: " << complexity << "\n";
-        file << "------------------------\n";
-        file.close();
-    }
+    auto now = std::chrono::system_clock::now();
+    auto time = std::chrono::system_clock::to_time_t(now);
+
+    struct tm timeinfo;
+#ifdef _WIN32
+    localtime_s(&timeinfo, &time);
+#else
+    localtime_r(&time, &timeinfo);
+#endif
+
+    std::stringstream ss;
+    ss << std::put_time(&timeinfo, "%Y-%m-%d %H:%M:%S");
+
+    TypingRecord record;
+    record.username = username;
+    record.date = ss.str();
+    record.wpm = calculateWPM();
+    record.accuracy = calculateAccuracy();
+    record.duration = duration;
+    record.difficulty = complexity;
+
+    // Written by the persistence thread so the render loop never waits on disk
+    PersistenceQueue::instance().saveTypingRecord(record);
 }
\ No newline at end of file
@@ -1,6 +1,11 @@
 #pragma once
 #include <string>
 #include "raylib.h"
+#include "HistoryStore.h"
+#include "TextLayout.h"
+#include "KeyboardLayouts.h"
+#include "GapBuffer.h"
+#include "FrameArena.h"
 #include <vector>
 #include <unordered_map>
 #include <random>
@@ -10,6 +15,7 @@ class TypingTest {
 public:
     // Constructor
     TypingTest(const std::string& username);
+    ~TypingTest();
     // Public member functions
     void displayMainMenu();
     void startTest();
@@ -30,7 +36,7 @@ public:
 private:
     // Menu-related functions
     void drawMainMenu();
-    void drawButton(int x, int y, int width, int height, const std::string& text, bool isSelected);
+    void drawButton(int x, int y, int width, int height, const char* text, bool isSelected);
     void handleMenuInput();
     void showCustomPassageInput();
     void updateCustomPassageInput();
@@ -40,8 +46,9 @@ private:
     // Custom passage input helper functions
     size_t getTextPositionFromMouse(Vector2 mousePos, Rectangle inputBox, float scrollOffset);
     float calculateMaxScroll(Rectangle inputBox);
-    std::vector<std::string> wrapText(const std::string& text, float maxWidth, int fontSize);
+    FrameVector<std::string_view> wrapText(std::string_view text, float maxWidth, int fontSize);
     void handleTextInput(size_t& selectionStart, size_t& selectionEnd);
+    void editCustomPassage(size_t position, size_t removed, std::string_view inserted);
     float Clamp(float value, float min, float max) {
         if (value < min) return min;
         if (value > max) return max;
@@ -53,11 +60,11 @@ private:
     void renderExitButton();
     void displayPassage();
     void renderKeyboard();
+    void buildKeyboardCache();
     void handleKeyPress();
     void calculateResults();
     std::string getRandomPassage(const std::string& filePath);
     void DrawKey(Rectangle keyRect, const char* key, bool isPressed);
-    float calculateRowWidth(const std::vector<std::string>& row, float baseKeyWidth, float spacing);
 
     // Member variables
     float passageScrollY;  // Add to private members
@@ -65,7 +72,13 @@ private:
     std::string username;
     std::string passage;
     std::string userInput;
-    std::string customPassage;
+    WrappedText passageLayout;   // Wrapped once per passage
+    WrappedText inputLayout;     // Rewrapped from inputEditStart when the input changes
+    bool passageLayoutDirty;
+    size_t inputEditStart;       // First input index changed since the last layout
+    GapBuffer customPassage;
+    WrappedText customLayout;    // Rewrapped around each edit, not per frame
+    static constexpr size_t MAX_CUSTOM_PASSAGE_CHARS = 512 * 1024;
     int duration;
     int complexity;
     bool useCustomPassage;
@@ -75,6 +88,18 @@ private:
     bool isTextSelected(size_t start, size_t end, size_t selStart, size_t selEnd);
 
     // Keyboard layout related
-    std::unordered_map<int, std::vector<std::string>> keyboardLayout;
-    std::unordered_map<std::string, float> specialKeyWidths;
+    size_t keyboardLayoutIndex;       // Into KEYBOARD_LAYOUTS
+
+    // A key of the on-screen keyboard with its screen rectangle, laid out once
+    struct KeyCap {
+        Rectangle rect;
+        const KeyDef* key;
+    };
+    std::vector<KeyCap> keyCaps;
+    size_t cachedLayoutIndex;
+    RenderTexture2D keyboardTexture;  // Every key drawn unpressed
+    Vector2 keyboardOrigin;           // Where the texture goes on screen
+    bool keyboardCached;
+    int keyboardScreenWidth;
+    int keyboardScreenHeight;
 };
\ No newline at end of file
@@ -0,0 +1,496 @@
+#include "UserDatabase.h"
+#include "MappedFile.h"
+#include "PasswordHash.h"
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    const char DATABASE_MAGIC[4] = { 'T', 'M', 'U', 'D' };
+    const char INDEX_MAGIC[4] = { 'T', 'M', 'U', 'I' };
+
+    bool validIndexHeader(const UserDatabase::IndexHeader& header) {
+        return std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+            header.version == UserDatabase::INDEX_VERSION &&
+            header.capacity > 0 && (header.capacity & (header.capacity - 1)) == 0;
+    }
+}
+
+UserDatabase::UserDatabase(const std::string& path, const std::string& legacyPath) :
+    path(path),
+    indexPath(path + ".idx"),
+    lockPath(path + ".lock") {
+
+    // Quick check without the lock; only the two headers are read
+    {
+        MappedFile existing;
+        if (existing.open(path) && validDatabase(existing.data(), existing.size()) &&
+            indexIsCurrent(recordCount(existing.data(), existing.size()))) {
+            return;
+        }
+    }
+
+    FileLock lock(lockPath);
+
+    // Import the old text file the first time the database is used
+    bool found = false;
+    {
+        MappedFile existing;
+        found = existing.open(path);
+    }
+    if (!found) {
+        std::ifstream legacy(legacyPath);
+        if (legacy.is_open()) {
+            legacy.close();
+            convertLegacy(legacyPath, path);
+        }
+        else {
+            std::ofstream created(path, std::ios::binary);
+            writeHeader(created);
+        }
+    }
+
+    MappedFile database;
+    if (database.open(path) && validDatabase(database.data(), database.size()) &&
+        !indexIsCurrent(recordCount(database.data(), database.size()))) {
+        rebuildIndex(database.data(), database.size());
+    }
+}
+
+bool UserDatabase::writeHeader(std::ostream& out, uint32_t version) {
+    DatabaseHeader header = {};
+    std::memcpy(header.magic, DATABASE_MAGIC, sizeof(DATABASE_MAGIC));
+    header.version = version;
+    header.recordSize = sizeof(UserRecord);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return static_cast<bool>(out);
+}
+
+uint32_t UserDatabase::headerVersion(const char* data, size_t size) {
+    if (data == nullptr || size < sizeof(DatabaseHeader)) return 0;
+
+    // Version 1 records have the same layout, only what may be in them differs
+    DatabaseHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, DATABASE_MAGIC, sizeof(DATABASE_MAGIC)) != 0 ||
+        header.recordSize != sizeof(UserRecord)) {
+        return 0;
+    }
+    return header.version;
+}
+
+bool UserDatabase::validDatabase(const char* data, size_t size) {
+    uint32_t version = headerVersion(data, size);
+    return version == 1 || version == VERSION;
+}
+
+uint32_t UserDatabase::recordCount(const char* data, size_t size) {
+    if (!validDatabase(data, size)) return 0;
+    // A record torn by a crash mid-append is ignored and later overwritten
+    return static_cast<uint32_t>((size - sizeof(DatabaseHeader)) / sizeof(UserRecord));
+}
+
+uint64_t UserDatabase::hashName(const char* username) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < USERNAME_SIZE && username[i] != '\0'; i++) {
+        hash ^= static_cast<unsigned char>(username[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+UserDatabase::UserRecord UserDatabase::toDisk(const Account& account) {
+    UserRecord record = {};
+    std::memcpy(record.username, account.username.data(), std::min(account.username.length(), USERNAME_SIZE - 1));
+    record.scheme = account.scheme;
+    record.iterations = account.iterations;
+    record.credentialLength = static_cast<uint32_t>(std::min(account.credential.length(), CREDENTIAL_SIZE));
+    std::memcpy(record.credential, account.credential.data(), record.credentialLength);
+    return record;
+}
+
+UserDatabase::Account UserDatabase::fromDisk(const UserRecord& record) {
+    Account account;
+    account.username = std::string(record.username, strnlen(record.username, USERNAME_SIZE));
+    account.scheme = record.scheme;
+    account.iterations = record.iterations;
+    account.credential = std::string(record.credential, std::min<size_t>(record.credentialLength, CREDENTIAL_SIZE));
+    return account;
+}
+
+bool UserDatabase::find(const std::string& username, Account& account) const {
+    if (username.empty() || username.length() >= USERNAME_SIZE) return false;
+
+    MappedFile database;
+    UserRecord record;
+    uint32_t recordNumber;
+    if (!database.open(path) || !findRecord(database.data(), database.size(), username, record, recordNumber)) {
+        return false;
+    }
+
+    account = fromDisk(record);
+    return true;
+}
+
+bool UserDatabase::exists(const std::string& username) const {
+    Account account;
+    return find(username, account);
+}
+
+bool UserDatabase::findRecord(const char* data, size_t size, const std::string& username,
+    UserRecord& record, uint32_t& recordNumber) const {
+    uint32_t count = recordCount(data, size);
+    const char* base = data + sizeof(DatabaseHeader);
+    auto matches = [&](uint32_t candidate) {
+        std::memcpy(&record, base + static_cast<size_t>(candidate) * sizeof(UserRecord), sizeof(record));
+        recordNumber = candidate;
+        return std::strncmp(record.username, username.c_str(), USERNAME_SIZE) == 0;
+    };
+
+    char key[USERNAME_SIZE] = {};
+    std::memcpy(key, username.data(), std::min(username.length(), USERNAME_SIZE - 1));
+
+    uint32_t covered = 0;
+    MappedFile index;
+    IndexHeader header;
+    if (index.open(indexPath) && index.size() >= sizeof(header)) {
+        std::memcpy(&header, index.data(), sizeof(header));
+        if (validIndexHeader(header) && index.size() >= sizeof(header) + header.capacity * sizeof(uint32_t)) {
+            covered = std::min(header.coveredRecords, count);
+
+            // Linear probing from the name's home slot until an empty slot
+            const char* slots = index.data() + sizeof(header);
+            uint32_t mask = header.capacity - 1;
+            uint32_t slot = static_cast<uint32_t>(hashName(key)) & mask;
+            for (uint32_t probes = 0; probes < header.capacity; probes++) {
+                uint32_t value;
+                std::memcpy(&value, slots + slot * sizeof(uint32_t), sizeof(value));
+                if (value == EMPTY_SLOT) break;
+                // Slots written by a newer process than our mapping are skipped
+                if (value - 1 < count && matches(value - 1)) return true;
+                slot = (slot + 1) & mask;
+            }
+        }
+    }
+
+    // Accounts appended after the index was last written
+    for (uint32_t candidate = covered; candidate < count; candidate++) {
+        if (matches(candidate)) return true;
+    }
+    return false;
+}
+
+bool UserDatabase::add(const Account& account) {
+    if (account.username.empty() || account.username.length() >= USERNAME_SIZE ||
+        account.credential.length() > CREDENTIAL_SIZE) {
+        return false;
+    }
+
+    // Held across the duplicate check and the append so two registrations
+    // of the same name can't both succeed
+    FileLock lock(lockPath);
+    if (!lock.isLocked()) return false;
+
+    uint32_t count = 0;
+    {
+        MappedFile database;
+        if (!database.open(path) || !validDatabase(database.data(), database.size())) return false;
+
+        UserRecord existing;
+        uint32_t existingNumber;
+        if (findRecord(database.data(), database.size(), account.username, existing, existingNumber)) return false;
+        count = recordCount(database.data(), database.size());
+    }
+
+    UserRecord record = toDisk(account);
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        if (!file.is_open()) return false;
+        file.seekp(sizeof(DatabaseHeader) + static_cast<size_t>(count) * sizeof(UserRecord));
+        file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        if (!file) return false;
+    }
+    if (!syncFile(path)) return false;
+
+    if (addToIndex(count, record.username)) return true;
+
+    // The index is missing, stale or too full; rebuild it with room to grow
+    MappedFile database;
+    return database.open(path) && rebuildIndex(database.data(), database.size());
+}
+
+bool UserDatabase::update(const Account& account) {
+    if (account.username.empty() || account.username.length() >= USERNAME_SIZE ||
+        account.credential.length() > CREDENTIAL_SIZE) {
+        return false;
+    }
+
+    FileLock lock(lockPath);
+    if (!lock.isLocked()) return false;
+
+    uint32_t recordNumber;
+    {
+        MappedFile database;
+        UserRecord existing;
+        if (!database.open(path) ||
+            !findRecord(database.data(), database.size(), account.username, existing, recordNumber)) {
+            return false;
+        }
+    }
+
+    // Same name, same slot; the index doesn't change
+    UserRecord record = toDisk(account);
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        if (!file.is_open()) return false;
+        file.seekp(sizeof(DatabaseHeader) + static_cast<size_t>(recordNumber) * sizeof(UserRecord));
+        file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        if (!file) return false;
+    }
+    return syncFile(path);
+}
+
+bool UserDatabase::indexIsCurrent(uint32_t records) const {
+    std::ifstream file(indexPath, std::ios::binary);
+    IndexHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    return validIndexHeader(header) && header.coveredRecords == records &&
+        static_cast<uint64_t>(records) * 2 <= header.capacity;
+}
+
+bool UserDatabase::rebuildIndex(const char* data, size_t size) const {
+    uint32_t count = recordCount(data, size);
+
+    // Rebuilt at most a quarter full, so it can double before the next rebuild
+    uint32_t capacity = MIN_INDEX_CAPACITY;
+    while (capacity < static_cast<uint64_t>(count) * 4) capacity *= 2;
+
+    std::vector<uint32_t> slots(capacity, EMPTY_SLOT);
+    uint32_t mask = capacity - 1;
+    const char* base = data + sizeof(DatabaseHeader);
+    for (uint32_t recordNumber = 0; recordNumber < count; recordNumber++) {
+        const char* username = base + static_cast<size_t>(recordNumber) * sizeof(UserRecord);
+        uint32_t slot = static_cast<uint32_t>(hashName(username)) & mask;
+        while (slots[slot] != EMPTY_SLOT) slot = (slot + 1) & mask;
+        slots[slot] = recordNumber + 1;
+    }
+
+    IndexHeader header = {};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = INDEX_VERSION;
+    header.capacity = capacity;
+    header.coveredRecords = count;
+
+    std::string tempPath = indexPath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(slots.data()), slots.size() * sizeof(uint32_t));
+        if (!file) return false;
+    }
+    return replaceFile(tempPath, indexPath);
+}
+
+bool UserDatabase::addToIndex(uint32_t recordNumber, const char* username) const {
+    std::fstream file(indexPath, std::ios::in | std::ios::out | std::ios::binary);
+    IndexHeader header;
+    if (!file.is_open() || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+
+    // Only extend an index that covers every earlier record and has room
+    if (!validIndexHeader(header) || header.coveredRecords != recordNumber ||
+        (static_cast<uint64_t>(recordNumber) + 1) * 2 > header.capacity) {
+        return false;
+    }
+
+    uint32_t mask = header.capacity - 1;
+    uint32_t slot = static_cast<uint32_t>(hashName(username)) & mask;
+    uint32_t value = EMPTY_SLOT;
+    for (uint32_t probes = 0; probes < header.capacity; probes++) {
+        file.seekg(sizeof(header) + static_cast<size_t>(slot) * sizeof(uint32_t));
+        if (!file.read(reinterpret_cast<char*>(&value), sizeof(value))) return false;
+        if (value == EMPTY_SLOT) break;
+        slot = (slot + 1) & mask;
+    }
+    if (value != EMPTY_SLOT) return false;
+
+    // Slot first, then the header, so a reader never trusts a missing slot
+    value = recordNumber + 1;
+    file.seekp(sizeof(header) + static_cast<size_t>(slot) * sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    header.coveredRecords = recordNumber + 1;
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return static_cast<bool>(file);
+}
+
+bool UserDatabase::hasPlaintext() const {
+    std::ifstream file(path, std::ios::binary);
+    DatabaseHeader header = {};
+    return file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+        headerVersion(reinterpret_cast<const char*>(&header), sizeof(header)) == 1;
+}
+
+std::vector<UserDatabase::Account> UserDatabase::plaintextAccounts(const char* data, size_t size) {
+    std::vector<Account> accounts;
+    uint32_t count = recordCount(data, size);
+    const char* base = data + sizeof(DatabaseHeader);
+    UserRecord record;
+    for (uint32_t recordNumber = 0; recordNumber < count; recordNumber++) {
+        std::memcpy(&record, base + static_cast<size_t>(recordNumber) * sizeof(UserRecord), sizeof(record));
+        if (record.scheme == SCHEME_PLAINTEXT) accounts.push_back(fromDisk(record));
+    }
+    return accounts;
+}
+
+void UserDatabase::hashPlaintext(std::vector<Account>& accounts, size_t threadCount) {
+    std::vector<Account*> plaintext;
+    for (Account& account : accounts) {
+        if (account.scheme == SCHEME_PLAINTEXT) plaintext.push_back(&account);
+    }
+    if (plaintext.empty()) return;
+
+    // Each hash is deliberately slow, so spread them over the threads
+    std::atomic<size_t> next{ 0 };
+    auto work = [&] {
+        for (size_t i = next++; i < plaintext.size(); i = next++) {
+            Account& account = *plaintext[i];
+            account.scheme = SCHEME_PBKDF2_SHA256;
+            account.iterations = PASSWORD_HASH_ITERATIONS;
+            account.credential = hashPassword(account.credential, PASSWORD_HASH_ITERATIONS);
+        }
+    };
+
+    threadCount = std::min(std::max<size_t>(threadCount, 1), plaintext.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; i++) threads.emplace_back(work);
+    work();
+    for (std::thread& thread : threads) thread.join();
+}
+
+bool UserDatabase::upgradePasswords(UpgradeProgress& progress) {
+    std::vector<Account> plaintext;
+    {
+        MappedFile database;
+        if (!database.open(path) || !validDatabase(database.data(), database.size())) return false;
+        if (headerVersion(database.data(), database.size()) == VERSION) return true;
+        plaintext = plaintextAccounts(database.data(), database.size());
+    }
+    progress.total = static_cast<uint32_t>(plaintext.size());
+
+    // Leave a core for the game; a batch takes about one hash per thread
+    unsigned int cores = std::thread::hardware_concurrency();
+    size_t threadCount = cores > 1 ? cores - 1 : 1;
+    for (size_t first = 0; first < plaintext.size(); first += threadCount) {
+        if (progress.cancelled) return false;
+
+        std::vector<Account> batch(plaintext.begin() + first,
+            plaintext.begin() + std::min(first + threadCount, plaintext.size()));
+        hashPlaintext(batch, threadCount);
+        if (!replacePlaintext(batch)) return false;
+        progress.upgraded += static_cast<uint32_t>(batch.size());
+    }
+
+    // Every record is hashed and on disk; only now may the file say so
+    FileLock lock(lockPath);
+    if (!lock.isLocked()) return false;
+    {
+        MappedFile database;
+        if (!database.open(path) || !validDatabase(database.data(), database.size()) ||
+            !plaintextAccounts(database.data(), database.size()).empty()) {
+            return false;
+        }
+    }
+
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file.is_open()) return false;
+    file.seekp(0);
+    if (!writeHeader(file)) return false;
+    file.close();
+    return file && syncFile(path);
+}
+
+bool UserDatabase::replacePlaintext(const std::vector<Account>& accounts) const {
+    FileLock lock(lockPath);
+    if (!lock.isLocked()) return false;
+
+    // Accounts hashed meanwhile by a login keep the hash they have
+    std::vector<std::pair<uint32_t, UserRecord>> writes;
+    {
+        MappedFile database;
+        if (!database.open(path)) return false;
+        for (const Account& account : accounts) {
+            UserRecord existing;
+            uint32_t recordNumber;
+            if (findRecord(database.data(), database.size(), account.username, existing, recordNumber) &&
+                existing.scheme == SCHEME_PLAINTEXT) {
+                writes.emplace_back(recordNumber, toDisk(account));
+            }
+        }
+    }
+
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    if (!file.is_open()) return false;
+    for (const auto& write : writes) {
+        file.seekp(sizeof(DatabaseHeader) + static_cast<size_t>(write.first) * sizeof(UserRecord));
+        file.write(reinterpret_cast<const char*>(&write.second), sizeof(write.second));
+    }
+    file.close();
+    return file && syncFile(path);
+}
+
+bool UserDatabase::writeDatabase(const std::vector<Account>& accounts, const std::string& path, uint32_t version) {
+    std::vector<UserRecord> records;
+    records.reserve(accounts.size());
+    for (const Account& account : accounts) records.push_back(toDisk(account));
+
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open() || !writeHeader(out, version)) return false;
+        out.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(UserRecord));
+        if (!out) return false;
+    }
+    return syncFile(tempPath) && replaceFile(tempPath, path);
+}
+
+bool UserDatabase::convertLegacy(const std::string& legacyPath, const std::string& path) {
+    std::vector<Account> accounts;
+    {
+        std::ifstream legacy(legacyPath);
+        if (!legacy.is_open()) return false;
+
+        std::unordered_map<std::string, size_t> positions;
+        std::string line, username, password;
+        while (std::getline(legacy, line)) {
+            std::istringstream iss(line);
+            if (!(iss >> username >> password)) continue;
+            if (username.length() >= USERNAME_SIZE) continue;
+
+            Account account;
+            account.username = username;
+            account.scheme = SCHEME_PLAINTEXT;
+            account.credential = password;
+
+            // A later line for the same user wins, as it did in the old map
+            auto inserted = positions.emplace(username, accounts.size());
+            if (inserted.second) accounts.push_back(account);
+            else accounts[inserted.first->second] = account;
+        }
+    }
+
+    // Hashing every password here would hold up startup for as long as
+    // there are accounts; the version 1 file leaves that to upgradePasswords()
+    if (!writeDatabase(accounts, path, 1)) return false;
+
+    // users.db is the only copy now, and the only one the upgrade clears
+    std::remove(legacyPath.c_str());
+    return true;
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Accounts in a fixed-width, append-only file (users.db) with an
+// open-addressing hash index beside it (users.db.idx). A lookup maps both
+// files and probes a few slots, so startup and login cost the same for ten
+// accounts or a hundred thousand. Registering appends one record and fills
+// one index slot; the index is only rewritten when it has to grow.
+//
+// Version 1 files can still hold passwords imported from users.txt in
+// plain text. Version 2 files never do. Opening a database never hashes
+// anything, since at PBKDF2 cost that takes a noticeable time per account;
+// upgradePasswords() hashes them in place from a worker and then marks the
+// file version 2, and a user who logs in first is hashed right away.
+class UserDatabase {
+public:
+    static constexpr uint32_t VERSION = 2;
+    static constexpr uint32_t INDEX_VERSION = 1;
+    static constexpr size_t USERNAME_SIZE = 32;
+    static constexpr size_t CREDENTIAL_SIZE = 64;
+    static constexpr uint32_t EMPTY_SLOT = 0;  // Slots hold record number + 1
+    static constexpr uint32_t MIN_INDEX_CAPACITY = 1024;
+
+    // How UserRecord::credential is to be checked against a password
+    enum Scheme : uint32_t {
+        SCHEME_PLAINTEXT = 0,      // Only in version 1 files, until upgradePasswords() or the user's next login
+        SCHEME_PBKDF2_SHA256 = 1   // Salt followed by the derived key
+    };
+
+    struct DatabaseHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t recordSize;
+        uint32_t reserved;
+    };
+
+    struct UserRecord {
+        char username[USERNAME_SIZE];
+        uint32_t scheme;
+        uint32_t iterations;
+        uint32_t credentialLength;
+        uint32_t reserved;
+        char credential[CREDENTIAL_SIZE];
+    };
+
+    // Followed by `capacity` uint32_t slots; capacity is a power of two
+    struct IndexHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t capacity;
+        uint32_t coveredRecords;  // Records the slots were filled from
+    };
+
+    struct Account {
+        std::string username;
+        uint32_t scheme = SCHEME_PLAINTEXT;
+        uint32_t iterations = 0;
+        std::string credential;
+    };
+
+    // Shared with the thread running upgradePasswords()
+    struct UpgradeProgress {
+        std::atomic<uint32_t> upgraded{ 0 };
+        std::atomic<uint32_t> total{ 0 };
+        std::atomic<bool> cancelled{ false };  // Stops after the accounts being hashed; the rest wait for next time
+    };
+
+    explicit UserDatabase(const std::string& path = "users.db",
+        const std::string& legacyPath = "users.txt");
+
+    bool find(const std::string& username, Account& account) const;
+    bool exists(const std::string& username) const;
+    // Appends a new account; false if the name is taken or the write failed
+    bool add(const Account& account);
+    // Rewrites an existing account's credential in place
+    bool update(const Account& account);
+
+    // True while the file is version 1 and may hold plaintext passwords
+    bool hasPlaintext() const;
+    // Hashes every plaintext password, a few accounts at a time on all but
+    // one core, saving each batch before starting the next. Returns true
+    // once the file is version 2; false if cancelled or a write failed,
+    // in which case the next call carries on from there.
+    bool upgradePasswords(UpgradeProgress& progress);
+
+    // One-time import of the old "username password" text file. Passwords
+    // are copied as they are into a version 1 file, and users.txt is
+    // deleted afterwards.
+    static bool convertLegacy(const std::string& legacyPath, const std::string& path);
+
+private:
+    std::string path;
+    std::string indexPath;
+    std::string lockPath;
+
+    static bool writeHeader(std::ostream& out, uint32_t version = VERSION);
+    static uint32_t headerVersion(const char* data, size_t size);
+    static bool validDatabase(const char* data, size_t size);
+    static uint32_t recordCount(const char* data, size_t size);
+    static uint64_t hashName(const char* username);
+    static UserRecord toDisk(const Account& account);
+    static Account fromDisk(const UserRecord& record);
+    static std::vector<Account> plaintextAccounts(const char* data, size_t size);
+    static void hashPlaintext(std::vector<Account>& accounts, size_t threadCount);
+    static bool writeDatabase(const std::vector<Account>& accounts, const std::string& path, uint32_t version);
+
+    bool findRecord(const char* data, size_t size, const std::string& username,
+        UserRecord& record, uint32_t& recordNumber) const;
+    bool indexIsCurrent(uint32_t records) const;
+    bool rebuildIndex(const char* data, size_t size) const;
+    bool addToIndex(uint32_t recordNumber, const char* username) const;
+    bool replacePlaintext(const std::vector<Account>& accounts) const;
+};
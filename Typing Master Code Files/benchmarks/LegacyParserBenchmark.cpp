@@ -0,0 +1,144 @@
+// Parses a generated legacy typing_history.txt with LegacyHistoryParser and
+// with the getline/substr/stoi loop Stats used before it, and reports MB/s.
+//
+//   LegacyParserBenchmark [--records N] [--runs N]
+#include "LegacyHistoryParser.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+namespace {
+    struct Checksum {
+        long long records = 0;
+        long long wpm = 0;
+        double accuracy = 0.0;
+        long long duration = 0;
+        long long difficulty = 0;
+        size_t textBytes = 0;
+
+        bool operator==(const Checksum& other) const {
+            return records == other.records && wpm == other.wpm && accuracy == other.accuracy &&
+                duration == other.duration && difficulty == other.difficulty && textBytes == other.textBytes;
+        }
+    };
+
+    void writeLegacyFile(const std::string& path, int records) {
+        std::ofstream out(path, std::ios::binary);
+        std::mt19937 random(42);
+        char block[256];
+        for (int i = 0; i < records; i++) {
+            // One draw per statement, so every compiler makes the same file
+            unsigned user = random() % 5000;
+            unsigned month = random() % 12 + 1;
+            unsigned day = random() % 28 + 1;
+            unsigned hour = random() % 24;
+            unsigned minute = random() % 60;
+            unsigned second = random() % 60;
+            unsigned wpm = random() % 150;
+            unsigned accuracy = random() % 100;
+            unsigned accuracyTenths = random() % 10;
+            unsigned duration = (random() % 4 + 1) * 15;
+            unsigned difficulty = random() % 3;
+            int length = std::snprintf(block, sizeof(block),
+                "User: user%u\nDate: 2024-%02u-%02u %02u:%02u:%02u\nWPM: %u\nAccuracy: %u.%u%%\n"
+                "Duration: %u seconds\nDifficulty: %u\n------------------------\n",
+                user, month, day, hour, minute, second, wpm, accuracy, accuracyTenths, duration, difficulty);
+            out.write(block, length);
+        }
+    }
+
+    Checksum parseStreaming(const std::string& path) {
+        Checksum sum;
+        LegacyHistoryParser parser(path);
+        parser.parse([&](const LegacyRecord& record) {
+            sum.records++;
+            sum.wpm += record.wpm;
+            sum.accuracy += record.accuracy;
+            sum.duration += record.duration;
+            sum.difficulty += record.difficulty;
+            sum.textBytes += record.username.length() + record.date.length();
+            });
+        return sum;
+    }
+
+    // The loop Stats::loadStats ran over typing_history.txt before the binary store
+    Checksum parseGetline(const std::string& path) {
+        Checksum sum;
+        std::ifstream file(path);
+        std::string line, username, date;
+        int wpm = 0, duration = 0, difficulty = 0;
+        float accuracy = 0.0f;
+
+        while (std::getline(file, line)) {
+            if (line.find("User: ") == 0) username = line.substr(6);
+            else if (line.find("Date: ") == 0) date = line.substr(6);
+            else if (line.find("WPM: ") == 0) wpm = std::stoi(line.substr(5));
+            else if (line.find("Accuracy: ") == 0) {
+                std::string acc = line.substr(10);
+                acc = acc.substr(0, acc.length() - 1);
+                accuracy = std::stof(acc);
+            }
+            else if (line.find("Duration: ") == 0) {
+                std::string dur = line.substr(10);
+                duration = std::stoi(dur.substr(0, dur.find(" ")));
+            }
+            else if (line.find("Difficulty: ") == 0) difficulty = std::stoi(line.substr(12));
+            else if (line.find("------------------------") == 0) {
+                sum.records++;
+                sum.wpm += wpm;
+                sum.accuracy += accuracy;
+                sum.duration += duration;
+                sum.difficulty += difficulty;
+                sum.textBytes += username.length() + date.length();
+            }
+        }
+        return sum;
+    }
+
+    template <typename Parse>
+    double bestMegabytesPerSecond(const char* name, Parse parse, const std::string& path, double megabytes,
+        int runs, Checksum& sum) {
+        double best = 0.0;
+        for (int run = 0; run < runs; run++) {
+            auto start = std::chrono::steady_clock::now();
+            sum = parse(path);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            best = std::max(best, megabytes / seconds);
+        }
+        std::printf("%-10s %8.1f MB/s  (%lld records, best of %d)\n", name, best, sum.records, runs);
+        return best;
+    }
+}
+
+int main(int argc, char** argv) {
+    int records = 1000000;
+    int runs = 3;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--records") == 0) records = std::atoi(argv[i + 1]);
+        else if (std::strcmp(argv[i], "--runs") == 0) runs = std::atoi(argv[i + 1]);
+    }
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() /
+        ("typingmaster-legacy-" + std::to_string(std::random_device{}()) + ".txt");
+    writeLegacyFile(path.string(), records);
+    double megabytes = std::filesystem::file_size(path) / (1024.0 * 1024.0);
+    std::printf("%d records, %.1f MB\n", records, megabytes);
+
+    Checksum streaming, getline;
+    double streamingRate = bestMegabytesPerSecond("streaming", parseStreaming, path.string(), megabytes, runs, streaming);
+    double getlineRate = bestMegabytesPerSecond("getline", parseGetline, path.string(), megabytes, runs, getline);
+    std::printf("speedup    %8.2fx\n", streamingRate / getlineRate);
+    std::filesystem::remove(path);
+
+    // Both parsers must have read the same fields
+    if (!(streaming == getline) || streaming.records != records) {
+        std::fprintf(stderr, "parsers disagree\n");
+        return 1;
+    }
+    return 0;
+}
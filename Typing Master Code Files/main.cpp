@@ -1,7 +1,29 @@
 #include"MainMenu.h"
+#include "RedrawScheduler.h"
+#include "FrameStats.h"
+#include <cstdlib>
+#include <cstring>
 
-int main() {
+int main(int argc, char* argv[]) {
+    RedrawScheduler& scheduler = RedrawScheduler::instance();
+    const char* gameSeed = nullptr;
+    for (int i = 1; i < argc; i++) {
+        // Lab machines idle on static screens; draw only when something changes
+        if (std::strcmp(argv[i], "--redraw-on-demand") == 0) scheduler.setOnDemand(true);
+        // Competitive typists: late input polling at the monitor's refresh rate
+        else if (std::strcmp(argv[i], "--low-latency") == 0) scheduler.setLowLatency(true);
+        // Frame rate cap, 0 for uncapped
+        else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc) scheduler.setTargetFps(std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--vsync") == 0) scheduler.setVsync(true);
+        // Print the overlay's CPU reading every second, for idle measurements
+        else if (std::strcmp(argv[i], "--cpu-log") == 0) FrameStats::instance().setCpuLog(true);
+        // Replays a falling words game; its seed is on the game over screen
+        else if (std::strcmp(argv[i], "--game-seed") == 0 && i + 1 < argc) gameSeed = argv[++i];
+    }
+
+    // Built after the flags, since opening the window reads the vsync choice
     MainMenu menu;
+    if (gameSeed) menu.setGameSeed((unsigned int)std::strtoul(gameSeed, nullptr, 10));
     menu.run();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "AllocationCounter.h"
+#include "TestSupport.h"
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace {
+    struct alignas(64) CacheLine {
+        char bytes[64];
+    };
+
+    // The compiler may drop a new/delete pair whose memory nobody sees
+    void* volatile escaped;
+    template <typename T>
+    T* keep(T* memory) {
+        escaped = memory;
+        return memory;
+    }
+
+    // Each form of operator new counts once, and its delete gives it back
+    // without upsetting the allocator
+    void everyForm() {
+        unsigned long long before = heapAllocationCount();
+        int* single = keep(new int(1));
+        CHECK_EQ(heapAllocationCount() - before, 1ull);
+        delete single;
+
+        before = heapAllocationCount();
+        int* array = keep(new int[16]);
+        CHECK_EQ(heapAllocationCount() - before, 1ull);
+        delete[] array;
+
+        before = heapAllocationCount();
+        int* quiet = keep(new (std::nothrow) int(2));
+        int* quietArray = keep(new (std::nothrow) int[4]);
+        CHECK(quiet != nullptr && quietArray != nullptr);
+        CHECK_EQ(heapAllocationCount() - before, 2ull);
+        delete quiet;
+        delete[] quietArray;
+
+        before = heapAllocationCount();
+        CacheLine* line = keep(new CacheLine);
+        CacheLine* lines = keep(new CacheLine[3]);
+        CacheLine* quietLine = keep(new (std::nothrow) CacheLine);
+        CHECK_EQ(heapAllocationCount() - before, 3ull);
+        CHECK_EQ(reinterpret_cast<std::uintptr_t>(line) % 64, 0u);
+        CHECK_EQ(reinterpret_cast<std::uintptr_t>(lines) % 64, 0u);
+        CHECK_EQ(reinterpret_cast<std::uintptr_t>(quietLine) % 64, 0u);
+        delete line;
+        delete[] lines;
+        delete quietLine;
+
+        // Odd sizes still come back aligned
+        before = heapAllocationCount();
+        void* odd = keep(::operator new(100, std::align_val_t(256)));
+        CHECK_EQ(reinterpret_cast<std::uintptr_t>(odd) % 256, 0u);
+        ::operator delete(odd, 100, std::align_val_t(256));
+        CHECK_EQ(heapAllocationCount() - before, 1ull);
+    }
+
+    // What the overlay counts in practice
+    void containers() {
+        unsigned long long before = heapAllocationCount();
+        std::vector<int> values;
+        values.reserve(100);
+        auto shared = std::make_shared<int>(3);
+        CHECK_EQ(heapAllocationCount() - before, 2ull);
+
+        before = heapAllocationCount();
+        for (int i = 0; i < 100; i++) values.push_back(i);
+        CHECK_EQ(heapAllocationCount() - before, 0ull);
+    }
+}
+
+int main() {
+    everyForm();
+    containers();
+    return test::failures();
+}
@@ -0,0 +1,207 @@
+#include "HighScoreLog.h"
+#include "HistoryStore.h"
+#include "TestSupport.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+// Several separate processes appending to one history and one high score
+// log at once, the way several copies of the game would. Run with no
+// arguments it starts the writers itself (re-running this executable with
+// --writer) and then checks what they left behind:
+//
+//   ConcurrentWritersTest [--writers N] [--records N]
+namespace {
+    int writerCount = 8;
+    int recordsPerWriter = 50;
+
+    std::string writerName(int writer) {
+        return "writer" + std::to_string(writer);
+    }
+
+    // Every writer also adds to this one user, so its chain is interleaved
+    // from all of them
+    const char* SHARED_USER = "shared";
+
+    TypingRecord makeRecord(const std::string& username, int wpm) {
+        TypingRecord record;
+        record.username = username;
+        record.date = "2030-01-01 00:00:00";
+        record.wpm = wpm;
+        record.accuracy = 95.0f;
+        record.duration = 60;
+        record.difficulty = 1;
+        return record;
+    }
+
+    int runWriter(const std::string& dir, int writer) {
+        HistoryStore store(dir + "/typing_history.dat", dir + "/typing_history.txt");
+        HighScoreLog log(dir + "/highscores.txt");
+        std::string username = writerName(writer);
+
+        for (int i = 1; i <= recordsPerWriter; i++) {
+            // Alternate single and batched appends; both take the same lock
+            bool saved;
+            if (i % 2 == 0) {
+                saved = store.append(makeRecord(username, i)) &&
+                    store.append(makeRecord(SHARED_USER, writer * 1000 + i));
+            } else {
+                saved = store.append({ makeRecord(username, i), makeRecord(SHARED_USER, writer * 1000 + i) }, false);
+            }
+            if (!saved) return 1;
+
+            if (!log.append({ { username, i * 10 } }, false)) return 1;
+            // Reading can compact the log while the others keep appending
+            if (i % 5 == 0) log.load();
+        }
+        return 0;
+    }
+
+    std::string quoted(const std::string& text) {
+        return "\"" + text + "\"";
+    }
+
+    bool runWriters(const std::string& self, const std::string& dir) {
+        std::vector<int> results(writerCount, -1);
+        std::vector<std::thread> threads;
+        for (int writer = 0; writer < writerCount; writer++) {
+            threads.emplace_back([&, writer] {
+                std::string command = quoted(self) + " --writer " + quoted(dir) + " " + std::to_string(writer) +
+                    " --records " + std::to_string(recordsPerWriter);
+#ifdef _WIN32
+                // cmd strips the outer pair of quotes from the whole line
+                command = "\"" + command + "\"";
+#endif
+                results[writer] = std::system(command.c_str());
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+
+        bool allSucceeded = true;
+        for (int writer = 0; writer < writerCount; writer++) {
+            if (results[writer] != 0) {
+                std::fprintf(stderr, "writer %d exited with %d\n", writer, results[writer]);
+                allSucceeded = false;
+            }
+        }
+        return allSucceeded;
+    }
+
+    void checkHistory(const HistoryStore& store) {
+        for (int writer = 0; writer < writerCount; writer++) {
+            std::vector<TypingRecord> records = store.loadUser(writerName(writer));
+            CHECK_EQ(records.size(), static_cast<size_t>(recordsPerWriter));
+            // One writer per user, so the chain is that writer's order, newest first
+            for (size_t i = 0; i < records.size(); i++) {
+                CHECK_EQ(records[i].wpm, recordsPerWriter - static_cast<int>(i));
+            }
+
+            HistoryStore::UserSummary summary = store.loadSummary(writerName(writer));
+            CHECK_EQ(summary.totalTests, recordsPerWriter);
+            CHECK_EQ(summary.bestWPM, recordsPerWriter);
+        }
+
+        // The shared chain holds every writer's results, each writer's still in order
+        std::vector<TypingRecord> shared = store.loadUser(SHARED_USER);
+        CHECK_EQ(shared.size(), static_cast<size_t>(writerCount * recordsPerWriter));
+        std::vector<int> nextExpected(writerCount, recordsPerWriter);
+        for (const TypingRecord& record : shared) {
+            int writer = record.wpm / 1000;
+            if (writer < 0 || writer >= writerCount) {
+                CHECK(!"shared record from an unknown writer");
+                continue;
+            }
+            CHECK_EQ(record.wpm % 1000, nextExpected[writer]);
+            nextExpected[writer]--;
+        }
+        CHECK_EQ(store.loadSummary(SHARED_USER).totalTests, writerCount * recordsPerWriter);
+    }
+
+    void checkHighScores(HighScoreLog& log) {
+        std::map<std::string, int> scores = log.load();
+        CHECK_EQ(scores.size(), static_cast<size_t>(writerCount));
+        for (int writer = 0; writer < writerCount; writer++) {
+            CHECK_EQ(scores[writerName(writer)], recordsPerWriter * 10);
+        }
+    }
+
+    void concurrentWriters(const std::string& self) {
+        test::TempDir dir("concurrent-writers");
+        CHECK(runWriters(self, dir.path("")));
+
+        HistoryStore store(dir.path("typing_history.dat"), dir.path("typing_history.txt"));
+        checkHistory(store);
+        HighScoreLog log(dir.path("highscores.txt"));
+        checkHighScores(log);
+
+        // The same answers come back when the index is rebuilt from the records
+        std::filesystem::remove(dir.path("typing_history.dat.idx"));
+        checkHistory(store);
+    }
+
+    // What a writer killed part-way through leaves behind: half a history
+    // record past the last whole one, and a compacted high score log that
+    // never got swapped in
+    void interruptedWriters() {
+        test::TempDir dir("interrupted-writers");
+        std::string path = dir.path("typing_history.dat");
+        HistoryStore store(path, dir.path("typing_history.txt"));
+        CHECK(store.append(makeRecord("alice", 40)));
+        CHECK(store.append(makeRecord("bob", 50)));
+
+        {
+            std::ofstream torn(path, std::ios::binary | std::ios::app);
+            std::string half(sizeof(HistoryStore::HistoryRecord) / 2, 'x');
+            torn.write(half.data(), half.size());
+        }
+        std::vector<TypingRecord> alice = store.loadUser("alice");
+        CHECK_EQ(alice.size(), static_cast<size_t>(1));
+
+        // The next append goes over the torn tail instead of after it
+        CHECK(store.append(makeRecord("alice", 45)));
+        alice = store.loadUser("alice");
+        CHECK_EQ(alice.size(), static_cast<size_t>(2));
+        if (alice.size() == 2) CHECK_EQ(alice[0].wpm, 45);
+        CHECK_EQ(std::filesystem::file_size(path),
+            sizeof(HistoryStore::HistoryHeader) + 3 * sizeof(HistoryStore::HistoryRecord));
+
+        std::string logPath = dir.path("highscores.txt");
+        {
+            std::ofstream stale(logPath + ".tmp");
+            stale << "alice 1\n";
+        }
+        HighScoreLog log(logPath);
+        for (int i = 1; i <= 40; i++) CHECK(log.append({ { "alice", i } }, false));
+        std::map<std::string, int> scores = log.load();
+        CHECK_EQ(scores["alice"], 40);
+
+        // That load compacted the log over the stale copy, down to one line
+        CHECK(!std::filesystem::exists(logPath + ".tmp"));
+        CHECK_EQ(std::filesystem::file_size(logPath), std::string("alice 40\n").size());
+        CHECK_EQ(log.load()["alice"], 40);
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string writerDir;
+    int writer = -1;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--writer") == 0 && i + 2 < argc) {
+            writerDir = argv[++i];
+            writer = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--writers") == 0 && i + 1 < argc) {
+            writerCount = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--records") == 0 && i + 1 < argc) {
+            recordsPerWriter = std::atoi(argv[++i]);
+        }
+    }
+    if (writer >= 0) return runWriter(writerDir, writer);
+
+    concurrentWriters(std::filesystem::absolute(argv[0]).string());
+    interruptedWriters();
+    return test::failures();
+}
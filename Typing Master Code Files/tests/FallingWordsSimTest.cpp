@@ -0,0 +1,227 @@
+#include "FallingWordsSim.h"
+#include "TestSupport.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+    const std::vector<std::string> WORDS = {
+        "apple", "banana", "cherry", "delta", "echo", "falcon", "garden", "harbor",
+        "island", "jungle", "kettle", "lemon", "mango", "nectar", "orbit", "pepper",
+    };
+    const unsigned int SEED = 20240501;
+    const long long MAX_STEPS = 60 * 60 * 10;
+
+    // Every field a step can change, folded into one number
+    class StateHash {
+    public:
+        template <typename T>
+        void add(const T& value) {
+            unsigned char bytes[sizeof(T)];
+            std::memcpy(bytes, &value, sizeof(T));
+            for (unsigned char byte : bytes) hash = (hash ^ byte) * 1099511628211ull;
+        }
+        uint64_t value() const { return hash; }
+
+    private:
+        uint64_t hash = 14695981039346656037ull;
+    };
+
+    uint64_t stateHash(const FallingWordsSim& sim) {
+        StateHash hash;
+        hash.add(sim.steps());
+        hash.add(sim.score());
+        hash.add(sim.lives());
+        hash.add(sim.combo());
+        hash.add(sim.comboTimer());
+        for (auto it = sim.words().begin(); it != sim.words().end(); ++it) {
+            hash.add(it.slot());
+            hash.add(it->wordIndex);
+            hash.add(it->typedLength);
+            hash.add(it->isActive);
+            hash.add(it->x);
+            hash.add(it->y);
+            hash.add(it->speed);
+            hash.add(it->hue);
+            hash.add(it->clickAnimScale);
+            for (const FallingWordsSim::CloudPoint& point : it->cloudPoints) {
+                hash.add(point.x);
+                hash.add(point.y);
+                hash.add(point.radius);
+            }
+        }
+        return hash.value();
+    }
+
+    // An input and the number of steps already run when it was queued,
+    // so the step that applies it is the next one
+    struct Input {
+        long long step;
+        char key;  // 0 for a click
+        float x, y;
+    };
+
+    // Plays by looking at the words each frame, the way a person would:
+    // keeps typing the active word or starts on the lowest, mistypes now
+    // and then, and sometimes clicks the highest word instead. It acts as
+    // often per second whatever the frame rate.
+    class Player {
+    public:
+        explicit Player(unsigned int seed) : random(seed) {}
+
+        void play(FallingWordsSim& sim, std::vector<Input>& log, float frameTime) {
+            const FallingWordsSim::FallingWord* active = nullptr;
+            const FallingWordsSim::FallingWord* lowest = nullptr;
+            const FallingWordsSim::FallingWord* highest = nullptr;
+            for (const FallingWordsSim::FallingWord& word : sim.words()) {
+                if (word.isActive) active = &word;
+                if (!lowest || word.y > lowest->y) lowest = &word;
+                if (!highest || word.y < highest->y) highest = &word;
+            }
+
+            float choice = (random() % 1000) / (frameTime * 60.0f);
+            if (choice < 3 && highest) {
+                queue(sim, log, { sim.steps(), 0, highest->x, highest->y });
+            }
+            else if (choice < 10) {
+                queue(sim, log, { sim.steps(), 'q', 0.0f, 0.0f });
+            }
+            else if (choice < 130 && active) {
+                queue(sim, log, { sim.steps(), sim.text(*active)[active->typedLength], 0.0f, 0.0f });
+            }
+            else if (choice < 130 && lowest) {
+                queue(sim, log, { sim.steps(), sim.text(*lowest)[0], 0.0f, 0.0f });
+            }
+        }
+
+    private:
+        static void queue(FallingWordsSim& sim, std::vector<Input>& log, const Input& input) {
+            log.push_back(input);
+            if (input.key) sim.queueKey(input.key);
+            else sim.queueClick(input.x, input.y);
+        }
+
+        std::mt19937 random;
+    };
+
+    struct Checkpoint {
+        long long steps;
+        uint64_t hash;
+    };
+
+    struct LiveGame {
+        std::vector<Input> inputs;
+        std::vector<Checkpoint> checkpoints;  // After every frame
+        int score = 0;
+        int lives = 0;
+    };
+
+    // A game played live at whatever frame times nextFrame() gives
+    template <typename NextFrame>
+    LiveGame playLive(NextFrame nextFrame) {
+        LiveGame game;
+        FallingWordsSim sim(WORDS);
+        sim.start(SEED, 1280.0f, 800.0f);
+        Player player(7);
+        while (!sim.isOver() && sim.steps() < MAX_STEPS) {
+            float frameTime = nextFrame();
+            player.play(sim, game.inputs, frameTime);
+            sim.advance(frameTime);
+            game.checkpoints.push_back({ sim.steps(), stateHash(sim) });
+        }
+        game.score = sim.score();
+        game.lives = sim.lives();
+        return game;
+    }
+
+    void queueInputsFor(FallingWordsSim& sim, const std::vector<Input>& inputs, size_t& next) {
+        for (; next < inputs.size() && inputs[next].step == sim.steps(); next++) {
+            if (inputs[next].key) sim.queueKey(inputs[next].key);
+            else sim.queueClick(inputs[next].x, inputs[next].y);
+        }
+    }
+
+    // Replaying the recorded inputs one step at a time, with no frames at
+    // all, has to pass through the same states the live game did
+    void checkReplay(const LiveGame& live) {
+        FallingWordsSim sim(WORDS);
+        sim.start(SEED, 1280.0f, 800.0f);
+        size_t next = 0;
+        bool same = true;
+        for (const Checkpoint& checkpoint : live.checkpoints) {
+            while (sim.steps() < checkpoint.steps) {
+                queueInputsFor(sim, live.inputs, next);
+                sim.step();
+            }
+            same = same && stateHash(sim) == checkpoint.hash;
+        }
+        CHECK(same);
+        CHECK_EQ(sim.score(), live.score);
+        CHECK_EQ(next, live.inputs.size());
+    }
+
+    void replays() {
+        std::mt19937 jitter(3);
+        const float step = FallingWordsSim::STEP;
+        LiveGame games[] = {
+            playLive([] { return 1.0f / 60.0f; }),
+            playLive([] { return 1.0f / 144.0f; }),
+            playLive([] { return 1.0f / 30.0f; }),
+            // Uneven frames, with the odd hitch longer than MAX_FRAME_TIME
+            playLive([&] { return jitter() % 50 == 0 ? 0.4f : step * (0.1f + (jitter() % 300) / 100.0f); }),
+        };
+
+        for (const LiveGame& game : games) {
+            // The player has to have scored, missed and clicked for the
+            // replay to cover anything
+            CHECK(game.score > 0);
+            CHECK(game.lives < FallingWordsSim::STARTING_LIVES);
+            CHECK(std::any_of(game.inputs.begin(), game.inputs.end(), [](const Input& input) { return input.key == 0; }));
+            checkReplay(game);
+        }
+    }
+
+    // The same inputs on the same steps give the same game at a different
+    // frame rate. Frames shorter than a step run at most one step each, so
+    // each input can be queued just before the step it was recorded for.
+    void otherFrameRates() {
+        LiveGame live = playLive([] { return 1.0f / 60.0f; });
+        std::mt19937 jitter(11);
+        FallingWordsSim sim(WORDS);
+        sim.start(SEED, 1280.0f, 800.0f);
+        size_t next = 0;
+        while (sim.steps() < live.checkpoints.back().steps && !sim.isOver()) {
+            queueInputsFor(sim, live.inputs, next);
+            sim.advance(FallingWordsSim::STEP * (0.1f + (jitter() % 80) / 100.0f));
+        }
+        CHECK_EQ(sim.steps(), live.checkpoints.back().steps);
+        CHECK_EQ(stateHash(sim), live.checkpoints.back().hash);
+        CHECK_EQ(sim.score(), live.score);
+    }
+
+    void seeds() {
+        FallingWordsSim first(WORDS);
+        FallingWordsSim second(WORDS);
+        first.start(1, 1280.0f, 800.0f);
+        second.start(2, 1280.0f, 800.0f);
+        for (int i = 0; i < 600; i++) {
+            first.step();
+            second.step();
+        }
+        CHECK(stateHash(first) != stateHash(second));
+
+        // Starting over with a seed replays it from the beginning
+        uint64_t hash = stateHash(first);
+        first.start(1, 1280.0f, 800.0f);
+        for (int i = 0; i < 600; i++) first.step();
+        CHECK_EQ(stateHash(first), hash);
+    }
+}
+
+int main() {
+    replays();
+    otherFrameRates();
+    seeds();
+    return test::failures();
+}
@@ -0,0 +1,89 @@
+#include "GapBuffer.h"
+#include "TestSupport.h"
+
+namespace {
+    void checkSame(const GapBuffer& buffer, const std::string& expected) {
+        CHECK_EQ(buffer.length(), expected.length());
+        CHECK_EQ(buffer.empty(), expected.empty());
+        CHECK_EQ(buffer.str(), expected);
+
+        bool sameChars = buffer.length() == expected.length();
+        for (size_t i = 0; sameChars && i < expected.length(); i++) sameChars = buffer[i] == expected[i];
+        CHECK(sameChars);
+    }
+
+    // Random edits mirrored on a std::string, weighted towards runs of
+    // typing at one spot like the editor sees, with jumps that drag the
+    // gap across the whole text
+    void randomEdits() {
+        std::mt19937 rng(7);
+        GapBuffer buffer;
+        std::string expected;
+        size_t cursor = 0;
+
+        for (int round = 0; round < 20000; round++) {
+            unsigned choice = rng() % 100;
+            if (choice < 10) {
+                cursor = expected.empty() ? 0 : rng() % (expected.length() + 1);
+            }
+            else if (choice < 60) {
+                std::string text(1 + rng() % (choice < 15 ? 300 : 3), 'a' + static_cast<char>(rng() % 26));
+                buffer.insert(cursor, text);
+                expected.insert(cursor, text);
+                cursor += text.length();
+            }
+            else if (choice < 85) {
+                if (cursor == 0) continue;
+                size_t count = std::min<size_t>(cursor, 1 + rng() % 4);
+                cursor -= count;
+                buffer.erase(cursor, count);
+                expected.erase(cursor, count);
+            }
+            else if (choice < 98) {
+                size_t count = 1 + rng() % 20;
+                buffer.erase(cursor, count);
+                if (cursor < expected.length()) expected.erase(cursor, count);
+            }
+            else {
+                buffer.clear();
+                expected.clear();
+                cursor = 0;
+            }
+
+            if (round % 250 == 0) checkSame(buffer, expected);
+
+            // Reads on both sides of the gap, and across it
+            size_t position = expected.empty() ? 0 : rng() % expected.length();
+            size_t count = rng() % 50;
+            CHECK_EQ(buffer.substr(position, count), expected.substr(position, count));
+        }
+        checkSame(buffer, expected);
+    }
+
+    void outOfRange() {
+        GapBuffer buffer;
+        buffer.insert(0, "hello");
+        buffer.insert(100, " world");  // Past the end appends
+        checkSame(buffer, "hello world");
+
+        buffer.erase(11, 3);  // Nothing there to erase
+        buffer.erase(5, 100); // Only up to the end
+        checkSame(buffer, "hello");
+        CHECK_EQ(buffer.substr(5, 3), std::string());
+        CHECK_EQ(buffer.substr(3, 100), std::string("lo"));
+
+        char dest[8] = {};
+        CHECK_EQ(buffer.copy(dest, 8, 1), (size_t)4);
+        CHECK_EQ(std::string(dest, 4), std::string("ello"));
+        CHECK_EQ(buffer.copy(dest, 8, 9), (size_t)0);
+
+        buffer.insert(2, 'X');
+        checkSame(buffer, "heXllo");
+    }
+}
+
+int main() {
+    randomEdits();
+    outOfRange();
+    return test::failures();
+}
@@ -0,0 +1,279 @@
+#include "HistoryStore.h"
+#include "TestSupport.h"
+#include <cstdio>
+#include <fstream>
+
+namespace {
+    TypingRecord makeRecord(const std::string& username, const std::string& date, int wpm, float accuracy) {
+        TypingRecord record;
+        record.username = username;
+        record.date = date;
+        record.wpm = wpm;
+        record.accuracy = accuracy;
+        record.duration = 60;
+        record.difficulty = 1;
+        return record;
+    }
+
+    void checkSame(const TypingRecord& actual, const TypingRecord& expected) {
+        CHECK_EQ(actual.username, expected.username);
+        CHECK_EQ(actual.date, expected.date);
+        CHECK_EQ(actual.wpm, expected.wpm);
+        CHECK_EQ(actual.accuracy, expected.accuracy);
+        CHECK_EQ(actual.duration, expected.duration);
+        CHECK_EQ(actual.difficulty, expected.difficulty);
+    }
+
+    // Recent dates, so nothing here is old enough to roll the segment over
+    std::string recentDate(int second) {
+        char date[HistoryStore::DATE_SIZE];
+        std::time_t now = std::time(nullptr);
+        std::tm timeinfo = *std::localtime(&now);
+        timeinfo.tm_sec = second % 60;
+        timeinfo.tm_min = second / 60 % 60;
+        std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &timeinfo);
+        return date;
+    }
+
+    void roundTrip() {
+        test::TempDir dir("history-roundtrip");
+        std::string path = dir.path("typing_history.dat");
+        std::string legacy = dir.path("typing_history.txt");
+
+        std::vector<TypingRecord> written;
+        for (int i = 0; i < 20; i++) {
+            const char* user = i % 3 == 0 ? "alice" : "bob";
+            written.push_back(makeRecord(user, recentDate(i), 40 + i, 90.0f + i * 0.25f));
+        }
+
+        {
+            HistoryStore store(path, legacy);
+            CHECK(store.append(std::vector<TypingRecord>(written.begin(), written.begin() + 10), true));
+            for (size_t i = 10; i < written.size(); i++) CHECK(store.append(written[i]));
+        }
+
+        // Appends change the index in place; a temporary one is only left
+        // behind by a rewrite that failed
+        CHECK(std::filesystem::exists(path + ".idx"));
+        CHECK(!std::filesystem::exists(path + ".idx.tmp"));
+
+        // A new instance reads what the first one wrote, newest first per user
+        HistoryStore store(path, legacy);
+        for (const char* user : { "alice", "bob" }) {
+            std::vector<TypingRecord> expected;
+            int best = 0;
+            double totalWpm = 0.0;
+            for (auto it = written.rbegin(); it != written.rend(); ++it) {
+                if (it->username != user) continue;
+                expected.push_back(*it);
+                best = std::max(best, it->wpm);
+                totalWpm += it->wpm;
+            }
+
+            std::vector<TypingRecord> loaded = store.loadUser(user);
+            CHECK_EQ(loaded.size(), expected.size());
+            for (size_t i = 0; i < loaded.size() && i < expected.size(); i++) checkSame(loaded[i], expected[i]);
+
+            HistoryStore::UserSummary summary = store.loadSummary(user);
+            CHECK_EQ(summary.totalTests, (int)expected.size());
+            CHECK_EQ(summary.bestWPM, best);
+            CHECK_EQ(summary.avgWPM, (float)(totalWpm / expected.size()));
+        }
+        CHECK(store.loadUser("carol").empty());
+        CHECK_EQ(store.loadSummary("carol").totalTests, 0);
+
+        // Losing the index only costs a rebuild
+        std::remove((path + ".idx").c_str());
+        CHECK_EQ(store.loadUser("alice").size(), (size_t)7);
+        CHECK_EQ(store.loadSummary("bob").totalTests, 13);
+    }
+
+    void checkTotals(const HistoryStore& store, const std::string& user, int tests, int best, double totalWpm) {
+        HistoryStore::UserSummary summary = store.loadSummary(user);
+        CHECK_EQ(summary.totalTests, tests);
+        CHECK_EQ(summary.bestWPM, best);
+        CHECK_EQ(summary.avgWPM, (float)(totalWpm / tests));
+    }
+
+    void rollover() {
+        test::TempDir dir("history-rollover");
+        std::string path = dir.path("typing_history.dat");
+        HistoryStore store(path, dir.path("typing_history.txt"));
+
+        // Results older than MAX_SEGMENT_AGE_DAYS seal the segment on the next append
+        CHECK(store.append({ makeRecord("alice", "2001-01-01 10:00:00", 30, 90.0f),
+            makeRecord("bob", "2001-01-02 10:00:00", 35, 91.0f),
+            makeRecord("alice", "2001-01-03 10:00:00", 32, 92.0f) }, false));
+        CHECK(!std::filesystem::exists(path + ".1"));
+        CHECK(store.append(makeRecord("alice", recentDate(0), 50, 95.0f)));
+        CHECK(std::filesystem::exists(path + ".1"));
+
+        // The newest sealed segment is still read record by record
+        std::vector<TypingRecord> alice = store.loadUser("alice");
+        CHECK_EQ(alice.size(), (size_t)3);
+        if (alice.size() == 3) {
+            CHECK_EQ(alice[0].wpm, 50);
+            checkSame(alice[1], makeRecord("alice", "2001-01-03 10:00:00", 32, 92.0f));
+            checkSame(alice[2], makeRecord("alice", "2001-01-01 10:00:00", 30, 90.0f));
+        }
+        CHECK_EQ(store.loadUser("bob").size(), (size_t)1);
+        CHECK(store.loadArchivedSummaries("alice").empty());
+        checkTotals(store, "alice", 3, 50, 112.0);
+
+        // Filling the active segment to MAX_SEGMENT_RECORDS seals it too
+        std::vector<TypingRecord> fill;
+        fill.reserve(HistoryStore::MAX_SEGMENT_RECORDS - 1);
+        for (uint32_t i = 0; i + 1 < HistoryStore::MAX_SEGMENT_RECORDS; i++) {
+            fill.push_back(makeRecord("carol", recentDate(i), 60, 96.0f));
+        }
+        CHECK(store.append(fill, false));
+        CHECK(!std::filesystem::exists(path + ".2"));
+        CHECK(store.append(makeRecord("alice", recentDate(1), 55, 97.0f)));
+        CHECK(std::filesystem::exists(path + ".2"));
+
+        // Segment 1 is now past the detailed ones and only shows as a summary
+        alice = store.loadUser("alice");
+        CHECK_EQ(alice.size(), (size_t)2);
+        if (alice.size() == 2) {
+            CHECK_EQ(alice[0].wpm, 55);
+            CHECK_EQ(alice[1].wpm, 50);
+        }
+        std::vector<HistoryStore::SegmentSummary> archived = store.loadArchivedSummaries("alice");
+        CHECK_EQ(archived.size(), (size_t)1);
+        if (!archived.empty()) {
+            CHECK_EQ(archived[0].firstDate, std::string("2001-01-01 10:00:00"));
+            CHECK_EQ(archived[0].lastDate, std::string("2001-01-03 10:00:00"));
+            CHECK_EQ(archived[0].stats.totalTests, 2);
+            CHECK_EQ(archived[0].stats.bestWPM, 32);
+        }
+        CHECK(store.loadUser("bob").empty());
+        CHECK_EQ(store.loadArchivedSummaries("bob").size(), (size_t)1);
+        CHECK_EQ(store.loadUser("carol").size(), (size_t)HistoryStore::MAX_SEGMENT_RECORDS - 1);
+
+        // All-time totals span every segment, and survive an index rebuild
+        for (int pass = 0; pass < 2; pass++) {
+            checkTotals(store, "alice", 4, 55, 167.0);
+            checkTotals(store, "bob", 1, 35, 35.0);
+            checkTotals(store, "carol", HistoryStore::MAX_SEGMENT_RECORDS - 1, 60,
+                60.0 * (HistoryStore::MAX_SEGMENT_RECORDS - 1));
+            std::remove((path + ".idx").c_str());
+        }
+    }
+
+    HistoryStore::IndexHeader readIndexHeader(std::istream& in) {
+        HistoryStore::IndexHeader header = {};
+        in.clear();
+        in.seekg(0);
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+        return header;
+    }
+
+    // Enough users for the index to grow several times, with appends for
+    // existing users in between that only touch their own slots
+    void manyUsers() {
+        test::TempDir dir("history-manyusers");
+        std::string path = dir.path("typing_history.dat");
+        HistoryStore store(path, dir.path("typing_history.txt"));
+
+        const int users = 2000;
+        std::vector<int> tests(users, 0);
+        std::vector<int> best(users, 0);
+        std::vector<double> totalWpm(users, 0.0);
+        for (int round = 0; round < 3; round++) {
+            for (int first = round; first < users; first += 25) {
+                std::vector<TypingRecord> batch;
+                for (int user = first; user < std::min(first + 25, users); user++) {
+                    int wpm = 20 + (user * 7 + round * 13) % 80;
+                    batch.push_back(makeRecord("user" + std::to_string(user), recentDate(round), wpm, 90.0f));
+                    tests[user]++;
+                    best[user] = std::max(best[user], wpm);
+                    totalWpm[user] += wpm;
+                }
+                CHECK(store.append(batch, false));
+            }
+        }
+
+        std::ifstream index(path + ".idx", std::ios::binary);
+        HistoryStore::IndexHeader header = readIndexHeader(index);
+        CHECK_EQ(header.entryCount, (uint32_t)users);
+        CHECK(header.capacity >= (uint32_t)users * 4 / 3);
+
+        for (int user = 0; user < users; user++) {
+            std::string name = "user" + std::to_string(user);
+            checkTotals(store, name, tests[user], best[user], totalWpm[user]);
+            CHECK_EQ(store.loadUser(name).size(), (size_t)tests[user]);
+        }
+
+        // The same file is updated, not replaced: the handle opened before
+        // the append sees the new record count
+        uint32_t covered = header.coveredRecords;
+        CHECK(store.append(makeRecord("user5", recentDate(5), 99, 90.0f)));
+        CHECK_EQ(readIndexHeader(index).coveredRecords, covered + 1);
+        checkTotals(store, "user5", tests[5] + 1, 99, totalWpm[5] + 99);
+    }
+
+    // A writer that dies between marking the index and finishing its
+    // update leaves the mark; readers and the next writer rebuild past it
+    void interruptedUpdate() {
+        test::TempDir dir("history-interrupted");
+        std::string path = dir.path("typing_history.dat");
+        HistoryStore store(path, dir.path("typing_history.txt"));
+        CHECK(store.append({ makeRecord("alice", recentDate(0), 40, 90.0f),
+            makeRecord("bob", recentDate(1), 50, 90.0f) }, true));
+
+        {
+            std::fstream index(path + ".idx", std::ios::in | std::ios::out | std::ios::binary);
+            HistoryStore::IndexHeader header = readIndexHeader(index);
+            header.coveredRecords = HistoryStore::NO_RECORD;
+            index.seekp(0);
+            index.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+
+        checkTotals(store, "alice", 1, 40, 40.0);
+        CHECK_EQ(store.loadUser("bob").size(), (size_t)1);
+
+        CHECK(store.append(makeRecord("alice", recentDate(2), 60, 90.0f)));
+        std::ifstream index(path + ".idx", std::ios::binary);
+        CHECK_EQ(readIndexHeader(index).coveredRecords, 3u);
+        checkTotals(store, "alice", 2, 60, 100.0);
+        checkTotals(store, "bob", 1, 50, 50.0);
+    }
+
+    void legacyImport() {
+        test::TempDir dir("history-legacy");
+        std::string path = dir.path("typing_history.dat");
+        std::string legacy = dir.path("typing_history.txt");
+        {
+            std::ofstream out(legacy);
+            out << "User: alice\nDate: 2024-01-02 10:00:00\nWPM: 55\nAccuracy: 97.5%\n"
+                "Duration: 60 seconds\nDifficulty: 2\n------------------------\n"
+                "User: bob\r\nDate: 2024-01-03 11:00:00\r\nWPM: 61\r\nAccuracy: 92%\r\n"
+                "Duration: 30 seconds\r\nDifficulty: 1\r\n------------------------\r\n";
+        }
+
+        HistoryStore store(path, legacy);
+        std::vector<TypingRecord> alice = store.loadUser("alice");
+        CHECK_EQ(alice.size(), (size_t)1);
+        if (!alice.empty()) {
+            TypingRecord expected = makeRecord("alice", "2024-01-02 10:00:00", 55, 97.5f);
+            expected.difficulty = 2;
+            checkSame(alice[0], expected);
+        }
+        std::vector<TypingRecord> bob = store.loadUser("bob");
+        CHECK_EQ(bob.size(), (size_t)1);
+        if (!bob.empty()) {
+            TypingRecord expected = makeRecord("bob", "2024-01-03 11:00:00", 61, 92.0f);
+            expected.duration = 30;
+            checkSame(bob[0], expected);
+        }
+    }
+}
+
+int main() {
+    roundTrip();
+    rollover();
+    manyUsers();
+    interruptedUpdate();
+    legacyImport();
+    return test::failures();
+}
@@ -0,0 +1,104 @@
+#include "Leaderboard.h"
+#include "TestSupport.h"
+#include <algorithm>
+
+namespace {
+    // The board's answers worked out the slow way, from a plain map
+    struct Reference {
+        std::map<std::string, int> best;
+
+        bool submit(const std::string& username, int score) {
+            auto inserted = best.emplace(username, score);
+            if (inserted.second) return true;
+            if (score <= inserted.first->second) return false;
+            inserted.first->second = score;
+            return true;
+        }
+
+        int rankOf(const std::string& username) const {
+            auto it = best.find(username);
+            if (it == best.end()) return 0;
+            int rank = 1;
+            for (const auto& pair : best) {
+                if (pair.second > it->second) rank++;
+            }
+            return rank;
+        }
+
+        std::vector<Leaderboard::Entry> sorted() const {
+            std::vector<Leaderboard::Entry> entries;
+            for (const auto& pair : best) entries.push_back({ pair.first, pair.second });
+            std::sort(entries.begin(), entries.end(), [](const Leaderboard::Entry& a, const Leaderboard::Entry& b) {
+                if (a.score != b.score) return a.score > b.score;
+                return a.username < b.username;
+            });
+            return entries;
+        }
+    };
+
+    void checkMatches(const Leaderboard& board, const Reference& reference) {
+        CHECK_EQ(board.playerCount(), reference.best.size());
+
+        std::vector<Leaderboard::Entry> expected = reference.sorted();
+        std::vector<Leaderboard::Entry> all = board.top(expected.size() + 5);
+        CHECK_EQ(all.size(), expected.size());
+        for (size_t i = 0; i < all.size() && i < expected.size(); i++) {
+            CHECK_EQ(all[i].username, expected[i].username);
+            CHECK_EQ(all[i].score, expected[i].score);
+        }
+        CHECK_EQ(board.top(3).size(), std::min<size_t>(3, expected.size()));
+
+        for (const auto& pair : reference.best) {
+            CHECK_EQ(board.scoreOf(pair.first), pair.second);
+            CHECK_EQ(board.rankOf(pair.first), reference.rankOf(pair.first));
+        }
+    }
+
+    void basics() {
+        Leaderboard board({ { "alice", 50 }, { "bob", 70 }, { "carol", 50 } });
+        CHECK_EQ(board.rankOf("bob"), 1);
+        CHECK_EQ(board.rankOf("alice"), 2);
+        CHECK_EQ(board.rankOf("carol"), 2);  // Tied scores share a rank
+        CHECK_EQ(board.rankOf("dave"), 0);
+        CHECK_EQ(board.scoreOf("dave"), 0);
+
+        CHECK(!board.submit("bob", 60));
+        CHECK(board.submit("carol", 80));
+        CHECK_EQ(board.rankOf("carol"), 1);
+        CHECK_EQ(board.rankOf("alice"), 3);
+
+        // Merging the log never lowers a best score
+        board.merge({ { "alice", 10 }, { "dave", 55 } });
+        CHECK_EQ(board.scoreOf("alice"), 50);
+        CHECK_EQ(board.rankOf("dave"), 3);
+        CHECK_EQ(board.playerCount(), (size_t)4);
+    }
+
+    void randomSubmits() {
+        std::mt19937 rng(1234);
+        Reference reference;
+        std::map<std::string, int> initial;
+        for (int i = 0; i < 50; i++) {
+            std::string name = "player" + std::to_string(i);
+            int score = static_cast<int>(rng() % 200);
+            initial[name] = score;
+            reference.submit(name, score);
+        }
+        Leaderboard board(initial);
+        checkMatches(board, reference);
+
+        for (int round = 0; round < 2000; round++) {
+            std::string name = "player" + std::to_string(rng() % 300);
+            int score = static_cast<int>(rng() % 1000);
+            CHECK_EQ(board.submit(name, score), reference.submit(name, score));
+            if (round % 100 == 0) checkMatches(board, reference);
+        }
+        checkMatches(board, reference);
+    }
+}
+
+int main() {
+    basics();
+    randomSubmits();
+    return test::failures();
+}
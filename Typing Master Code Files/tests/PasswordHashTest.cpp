@@ -0,0 +1,66 @@
+#include "PasswordHash.h"
+#include "TestSupport.h"
+
+namespace {
+    std::string toHex(const std::string& bytes) {
+        static const char digits[] = "0123456789abcdef";
+        std::string hex;
+        for (unsigned char byte : bytes) {
+            hex += digits[byte >> 4];
+            hex += digits[byte & 0x0F];
+        }
+        return hex;
+    }
+
+    // Published PBKDF2-HMAC-SHA256 outputs. Vectors with a longer dkLen
+    // are cut to our 32 bytes; PBKDF2's first block doesn't depend on dkLen.
+    void knownVectors() {
+        struct Vector {
+            std::string password;
+            std::string salt;
+            uint32_t iterations;
+            const char* key;
+        };
+        const Vector vectors[] = {
+            // RFC 7914 section 11
+            { "passwd", "salt", 1, "55ac046e56e3089fec1691c22544b605f94185216dde0465e68b9d57c20dacbc" },
+            { "Password", "NaCl", 80000, "4ddcd8f60b98be21830cee5ef22701f9641a4418d04c0414aeff08876b34ab56" },
+            // The RFC 6070 inputs, run with SHA-256
+            { "password", "salt", 1, "120fb6cffcf8b32c43e7225256c4f837a86548c92ccc35480805987cb70be17b" },
+            { "password", "salt", 2, "ae4d0c95af6b46d32d0adff928f06dd02a303f8ef3c251dfd6e2d85a95474c43" },
+            { "password", "salt", 4096, "c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a4963873aa98134a" },
+            { "passwordPASSWORDpassword", "saltSALTsaltSALTsaltSALTsaltSALTsalt", 4096,
+                "348c89dbcbd32b2f32d814b8116e84cf2b17347ebc1800181c4e2a1fb8dd53e1" },
+        };
+
+        for (const Vector& vector : vectors) {
+            CHECK_EQ(toHex(pbkdf2Sha256(vector.password, vector.salt, vector.iterations)), std::string(vector.key));
+        }
+
+        // Embedded NULs are part of the input, not the end of it
+        std::string key = pbkdf2Sha256(std::string("pass\0word", 9), std::string("sa\0lt", 5), 4096);
+        CHECK_EQ(toHex(key).substr(0, 32), std::string("89b69d0516f829893c696226650a8687"));
+    }
+
+    void storedCredentials() {
+        std::string first = hashPassword("hunter2", 1000);
+        std::string second = hashPassword("hunter2", 1000);
+        CHECK_EQ(first.size(), PASSWORD_SALT_SIZE + PASSWORD_KEY_SIZE);
+        CHECK(first != second);  // Fresh salt each time
+
+        CHECK(verifyPassword("hunter2", first, 1000));
+        CHECK(verifyPassword("hunter2", second, 1000));
+        CHECK(!verifyPassword("hunter3", first, 1000));
+        CHECK(!verifyPassword("hunter2", first, 1001));
+        CHECK(!verifyPassword("hunter2", first.substr(1), 1000));
+
+        // The key is PBKDF2 over the stored salt
+        CHECK_EQ(first.substr(PASSWORD_SALT_SIZE), pbkdf2Sha256("hunter2", first.substr(0, PASSWORD_SALT_SIZE), 1000));
+    }
+}
+
+int main() {
+    knownVectors();
+    storedCredentials();
+    return test::failures();
+}
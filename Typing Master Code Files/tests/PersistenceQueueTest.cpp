@@ -0,0 +1,55 @@
+#include "HighScoreLog.h"
+#include "PersistenceQueue.h"
+#include "TestSupport.h"
+#include <filesystem>
+
+namespace {
+    TypingRecord makeRecord(const std::string& username, int wpm) {
+        TypingRecord record;
+        record.username = username;
+        record.date = "2030-01-01 00:00:00";
+        record.wpm = wpm;
+        record.accuracy = 95.0f;
+        record.duration = 60;
+        record.difficulty = 1;
+        return record;
+    }
+
+    // A history file that can't be written keeps its batch queued; the
+    // high scores saved alongside it still go out, and once the file can
+    // be written the retry saves every result exactly once
+    void retriesFailedSaves() {
+        PersistenceQueue& queue = PersistenceQueue::instance();
+        std::filesystem::create_directory("typing_history.dat");
+
+        queue.saveTypingRecord(makeRecord("alice", 40));
+        queue.saveHighScore("alice", 300);
+        CHECK(!queue.flush());
+        CHECK(queue.saveFailing());
+        queue.saveTypingRecord(makeRecord("alice", 50));
+
+        std::filesystem::remove("typing_history.dat");
+        CHECK(queue.flush());
+        CHECK(!queue.saveFailing());
+
+        HistoryStore store;
+        std::vector<TypingRecord> records = store.loadUser("alice");
+        CHECK_EQ(records.size(), 2u);
+        if (records.size() == 2) {
+            // Newest first, and still in the order they were queued
+            CHECK_EQ(records[0].wpm, 50);
+            CHECK_EQ(records[1].wpm, 40);
+        }
+        CHECK_EQ(HighScoreLog().load()["alice"], 300);
+    }
+}
+
+int main() {
+    // The queue writes to the working directory, like the game
+    test::TempDir dir("persistencequeue");
+    std::filesystem::path previous = std::filesystem::current_path();
+    std::filesystem::current_path(dir.path(""));
+    retriesFailedSaves();
+    std::filesystem::current_path(previous);
+    return test::failures();
+}
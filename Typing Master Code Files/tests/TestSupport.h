@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+
+// Just enough for the unit tests: CHECK and CHECK_EQ report a failure and
+// carry on, and main() returns test::failures().
+namespace test {
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline void check(bool passed, const char* expression, const char* file, int line) {
+        if (passed) return;
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        failures()++;
+    }
+
+    template <typename A, typename B>
+    void checkEqual(const A& actual, const B& expected, const char* expression, const char* file, int line) {
+        if (actual == expected) return;
+        std::cerr << file << ":" << line << ": check failed: " << expression
+            << "\n  actual:   " << actual << "\n  expected: " << expected << "\n";
+        failures()++;
+    }
+
+    // An empty directory of its own for one test's files, deleted afterwards
+    class TempDir {
+    public:
+        explicit TempDir(const std::string& name) {
+            static std::atomic<int> counter{ 0 };
+            root = std::filesystem::temp_directory_path() /
+                ("typingmaster-" + name + "-" + std::to_string(std::random_device{}()) + "-" + std::to_string(counter++));
+            std::filesystem::remove_all(root);
+            std::filesystem::create_directories(root);
+        }
+        ~TempDir() {
+            std::error_code ignored;
+            std::filesystem::remove_all(root, ignored);
+        }
+        TempDir(const TempDir&) = delete;
+        TempDir& operator=(const TempDir&) = delete;
+
+        std::string path(const std::string& file) const { return (root / file).string(); }
+
+    private:
+        std::filesystem::path root;
+    };
+}
+
+#define CHECK(expression) test::check((expression), #expression, __FILE__, __LINE__)
+#define CHECK_EQ(actual, expected) test::checkEqual((actual), (expected), #actual " == " #expected, __FILE__, __LINE__)
@@ -0,0 +1,132 @@
+#include "TextWrap.h"
+#include "GapBuffer.h"
+#include "TestSupport.h"
+#include <string>
+
+namespace {
+    // Made-up metrics with a different advance per letter, so a wrap that
+    // gets a width wrong shows up in where lines break
+    GlyphMetrics testMetrics() {
+        float advances[128] = {};
+        for (int c = 32; c < 128; c++) advances[c] = 4.0f + c % 7;
+        return GlyphMetrics(advances, 1.0f);
+    }
+
+    std::string randomText(std::mt19937& rng, size_t length) {
+        static const char alphabet[] = "abcdefghij klmnop qrstuvw xyz  ABC.,";
+        std::string text;
+        for (size_t i = 0; i < length; i++) text += alphabet[rng() % (sizeof(alphabet) - 1)];
+        return text;
+    }
+
+    void widths() {
+        GlyphMetrics metrics = testMetrics();
+        CHECK_EQ(metrics.width(""), 0.0f);
+        CHECK_EQ(metrics.width("a"), metrics.advance('a'));
+        CHECK_EQ(metrics.width("ab"), metrics.advance('a') + metrics.advance('b') + 1.0f);
+
+        // Line breaks measure the widest line, as MeasureText does
+        CHECK_EQ(metrics.width("ab\nabcd\nc"), metrics.width("abcd"));
+        CHECK_EQ(metrics.width("abcd\n"), metrics.width("abcd"));
+        CHECK_EQ(metrics.width("\n\nab"), metrics.width("ab"));
+        CHECK_EQ(metrics.width("\n"), 0.0f);
+    }
+
+    void checkSameLines(const std::vector<TextLine>& actual, const std::vector<TextLine>& expected) {
+        CHECK_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < actual.size() && i < expected.size(); i++) {
+            CHECK_EQ(actual[i].start, expected[i].start);
+            CHECK_EQ(actual[i].length, expected[i].length);
+        }
+    }
+
+    void wrapping() {
+        GlyphMetrics metrics = testMetrics();
+        std::mt19937 rng(42);
+        for (int round = 0; round < 500; round++) {
+            std::string text = randomText(rng, rng() % 400);
+            float maxWidth = 40.0f + rng() % 300;
+            std::vector<TextLine> lines = wrapLines(text, maxWidth, metrics);
+
+            // Lines cover the text in order, and only a single word overflows
+            size_t next = 0;
+            for (const TextLine& line : lines) {
+                CHECK_EQ(line.start, next);
+                std::string_view lineText = std::string_view(text).substr(line.start, line.length);
+                if (metrics.width(lineText) > maxWidth) {
+                    CHECK(lineText.find(' ', 1) == std::string_view::npos);
+                }
+                next = line.start + line.length;
+            }
+            CHECK_EQ(next, text.length());
+
+            // The line-at-a-time wrap used for gap buffers agrees with it
+            WrappedText byLine;
+            byLine.assignLines(text, maxWidth, metrics);
+            checkSameLines(byLine.lines(), lines);
+
+            WrappedText whole;
+            whole.assign(text, maxWidth, metrics);
+            checkSameLines(whole.lines(), lines);
+        }
+    }
+
+    // Edits as the custom passage editor makes them: rewrapping around each
+    // one has to give the lines a full rewrap would
+    void incrementalEdits() {
+        GlyphMetrics metrics = testMetrics();
+        std::mt19937 rng(99);
+        for (int text = 0; text < 20; text++) {
+            float maxWidth = 60.0f + rng() % 250;
+            GapBuffer buffer;
+            std::string initial = randomText(rng, rng() % 300);
+            buffer.insert(0, initial);
+
+            WrappedText layout;
+            layout.assignLines(buffer, maxWidth, metrics);
+            for (int round = 0; round < 300; round++) {
+                size_t position = rng() % (buffer.length() + 1);
+                size_t removed = rng() % 3 == 0 ? std::min<size_t>(buffer.length() - position, rng() % 12) : 0;
+                std::string inserted = rng() % 4 == 0 ? std::string() : randomText(rng, 1 + rng() % (rng() % 5 == 0 ? 40 : 2));
+
+                buffer.erase(position, removed);
+                buffer.insert(position, inserted);
+                layout.edit(buffer, position, removed, inserted.length());
+
+                WrappedText full;
+                full.assignLines(buffer, maxWidth, metrics);
+                checkSameLines(layout.lines(), full.lines());
+            }
+        }
+    }
+
+    // update() rewraps a contiguous text from the first changed character
+    void tailUpdates() {
+        GlyphMetrics metrics = testMetrics();
+        std::mt19937 rng(5);
+        std::string text;
+        WrappedText layout;
+        layout.assign(text, 120.0f, metrics);
+        for (int round = 0; round < 2000; round++) {
+            size_t firstChanged;
+            if (rng() % 4 == 0 && !text.empty()) {
+                firstChanged = text.length() - std::min<size_t>(text.length(), 1 + rng() % 6);
+                text.erase(firstChanged);
+            }
+            else {
+                firstChanged = text.length();
+                text += randomText(rng, 1 + rng() % 3);
+            }
+            layout.update(text, firstChanged);
+            checkSameLines(layout.lines(), wrapLines(text, 120.0f, metrics));
+        }
+    }
+}
+
+int main() {
+    widths();
+    wrapping();
+    incrementalEdits();
+    tailUpdates();
+    return test::failures();
+}
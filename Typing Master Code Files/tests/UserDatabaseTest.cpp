@@ -0,0 +1,141 @@
+#include "UserDatabase.h"
+#include "PasswordHash.h"
+#include "TestSupport.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace {
+    std::string readAll(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void checkHashed(const UserDatabase& database, const std::string& username, const std::string& password) {
+        UserDatabase::Account account;
+        CHECK(database.find(username, account));
+        CHECK_EQ(account.scheme, (uint32_t)UserDatabase::SCHEME_PBKDF2_SHA256);
+        CHECK_EQ(account.iterations, PASSWORD_HASH_ITERATIONS);
+        CHECK(verifyPassword(password, account.credential, account.iterations));
+        CHECK(!verifyPassword(password + "x", account.credential, account.iterations));
+    }
+
+    void checkPlaintext(const UserDatabase& database, const std::string& username, const std::string& password) {
+        UserDatabase::Account account;
+        CHECK(database.find(username, account));
+        CHECK_EQ(account.scheme, (uint32_t)UserDatabase::SCHEME_PLAINTEXT);
+        CHECK_EQ(account.credential, password);
+    }
+
+    void legacyImport() {
+        test::TempDir dir("users-legacy");
+        std::string path = dir.path("users.db");
+        std::string legacy = dir.path("users.txt");
+        {
+            std::ofstream out(legacy);
+            out << "alice correcthorse\nbob hunter2\nalice batterystaple\n";
+        }
+
+        // Opening only copies the passwords across; hashing them is left
+        // to the upgrade, so it doesn't hold up startup
+        UserDatabase database(path, legacy);
+        CHECK(!std::filesystem::exists(legacy));
+        CHECK(database.hasPlaintext());
+        checkPlaintext(database, "alice", "batterystaple");
+        checkPlaintext(database, "bob", "hunter2");
+
+        UserDatabase::UpgradeProgress progress;
+        CHECK(database.upgradePasswords(progress));
+        CHECK_EQ(progress.total.load(), 2u);
+        CHECK_EQ(progress.upgraded.load(), 2u);
+        CHECK(!database.hasPlaintext());
+        checkHashed(database, "alice", "batterystaple");
+        checkHashed(database, "bob", "hunter2");
+
+        // No password is left readable anywhere
+        std::string stored = readAll(path);
+        CHECK(stored.find("hunter2") == std::string::npos);
+        CHECK(stored.find("batterystaple") == std::string::npos);
+        CHECK(stored.find("correcthorse") == std::string::npos);
+    }
+
+    void upgradeVersion1() {
+        test::TempDir dir("users-upgrade");
+        std::string path = dir.path("users.db");
+
+        // A version 1 file as the first import wrote it, passwords as they were
+        {
+            std::ofstream out(path, std::ios::binary);
+            UserDatabase::DatabaseHeader header = {};
+            std::memcpy(header.magic, "TMUD", 4);
+            header.version = 1;
+            header.recordSize = sizeof(UserDatabase::UserRecord);
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            const char* accounts[][2] = { { "carol", "letmein" }, { "dave", "trustno1" } };
+            for (const auto& account : accounts) {
+                UserDatabase::UserRecord record = {};
+                std::strcpy(record.username, account[0]);
+                record.scheme = UserDatabase::SCHEME_PLAINTEXT;
+                record.credentialLength = static_cast<uint32_t>(std::strlen(account[1]));
+                std::memcpy(record.credential, account[1], record.credentialLength);
+                out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+            }
+        }
+
+        UserDatabase database(path, dir.path("users.txt"));
+        checkPlaintext(database, "carol", "letmein");
+        checkPlaintext(database, "dave", "trustno1");
+
+        // Cancelled before it starts, nothing changes and it can run again
+        UserDatabase::UpgradeProgress cancelled;
+        cancelled.cancelled = true;
+        CHECK(!database.upgradePasswords(cancelled));
+        CHECK(database.hasPlaintext());
+        checkPlaintext(database, "carol", "letmein");
+
+        // Dave logs in first and gets his hash then; the upgrade keeps it
+        UserDatabase::Account dave;
+        dave.username = "dave";
+        dave.scheme = UserDatabase::SCHEME_PBKDF2_SHA256;
+        dave.iterations = PASSWORD_HASH_ITERATIONS;
+        dave.credential = hashPassword("trustno1", PASSWORD_HASH_ITERATIONS);
+        CHECK(database.update(dave));
+
+        UserDatabase::UpgradeProgress progress;
+        CHECK(database.upgradePasswords(progress));
+        CHECK(!database.hasPlaintext());
+        checkHashed(database, "carol", "letmein");
+        checkHashed(database, "dave", "trustno1");
+        UserDatabase::Account stored;
+        CHECK(database.find("dave", stored));
+        CHECK(stored.credential == dave.credential);
+
+        // Reopening a version 2 file finds nothing left to do
+        UserDatabase reopened(path, dir.path("users.txt"));
+        CHECK(!reopened.hasPlaintext());
+        CHECK(reopened.upgradePasswords(progress));
+
+        std::string contents = readAll(path);
+        CHECK(contents.find("letmein") == std::string::npos);
+        CHECK(contents.find("trustno1") == std::string::npos);
+
+        // New accounts go in after the upgraded ones
+        UserDatabase::Account erin;
+        erin.username = "erin";
+        erin.scheme = UserDatabase::SCHEME_PBKDF2_SHA256;
+        erin.iterations = 1;
+        erin.credential = hashPassword("opensesame", 1);
+        CHECK(database.add(erin));
+        CHECK(!database.add(erin));
+        CHECK(database.exists("erin"));
+        CHECK(database.exists("carol"));
+        CHECK(!database.exists("frank"));
+    }
+}
+
+int main() {
+    legacyImport();
+    upgradeVersion1();
+    return test::failures();
+}